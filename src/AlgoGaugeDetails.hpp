@@ -5,6 +5,11 @@
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
+#include "algorithms/Allocation.hpp"
+#include "algorithms/RandomNum.hpp"
+#include "algorithms/ResultWriter.hpp"
+#include "algorithms/Timer.hpp"
+#include "algorithms/Isolation.hpp"
 namespace AlgoGauge {
 
 /**
@@ -17,22 +22,39 @@ enum AlgorithmOptions {
 	repeatedSet,
 	chunkSet,
 	reversedSet,
-	sortedSet
+	sortedSet,
+	zipfSet,
+	gaussianSet,
+	nearlySortedSet,
+	organPipeSet,
+	sawtoothSet,
+	fewUniqueSet,
+	fileSet
 };
 
 enum PERF{
 	perfOFF,
 	perfON,
-	sample
+	sample,
+	perfGrouped // perfON with the hardware counters measured in groups, one group per repetition
 };
 const std::unordered_map<std::string, AlgoGauge::AlgorithmOptions> strategyMap = {
         {"random", AlgoGauge::AlgorithmOptions::randomSet},
         {"repeated", AlgoGauge::AlgorithmOptions::repeatedSet},
         {"chunks", AlgoGauge::AlgorithmOptions::chunkSet},
         {"sorted_reversed", AlgoGauge::AlgorithmOptions::reversedSet},
-        {"sorted", AlgoGauge::AlgorithmOptions::sortedSet}
+        {"sorted", AlgoGauge::AlgorithmOptions::sortedSet},
+        {"zipf", AlgoGauge::AlgorithmOptions::zipfSet},
+        {"gaussian", AlgoGauge::AlgorithmOptions::gaussianSet},
+        {"nearly_sorted", AlgoGauge::AlgorithmOptions::nearlySortedSet},
+        {"organ_pipe", AlgoGauge::AlgorithmOptions::organPipeSet},
+        {"sawtooth", AlgoGauge::AlgorithmOptions::sawtoothSet},
+        {"few_unique", AlgoGauge::AlgorithmOptions::fewUniqueSet},
+        {"file", AlgoGauge::AlgorithmOptions::fileSet}
 };
 
+const std::unordered_set<std::string> keyTypes = {"uint32", "uint64", "float", "double", "string16", "record16", "record64"};
+
 const std::unordered_set<std::string> crudOperations = {"push_front", "push_back", "pop_front", "pop_back", "push_pop_back", "push_pop_front"};
 
 struct HashTableSettings{
@@ -49,8 +71,15 @@ struct SortingAlgorithmSettings {
 	std::string Algorithm = "built_in";
 	std::string ArrayStrategyString = "default";
 	AlgorithmOptions ArrayStrategy = none;
+	std::string InputFile = ""; // Binary file of raw keys for the file strategy
+	double StrategyParameter = 0; // Skew, deviation, percent, period or cardinality for the strategies that take one. 0 uses the strategy's default
     int ArrayLength = 100;
 	std::string Language = "C++";
+	unsigned int Threads = 0; // 0 means use every hardware thread. Only used by parallel algorithms
+	unsigned int Cutoff = 0; // 0 means use the algorithm's default sequential cutoff
+	unsigned int K = 2; // Number of runs merged at once by the K-way merge sorts
+	std::string KeyType = "uint32"; // The type of element being sorted. Must be one of keyTypes
+	Allocation::Policy MemoryPolicy = Allocation::systemDefault; // How the sort's buffers are allocated
 };
 struct CRUDOperationSettings{
 	std::string Name = "";
@@ -67,7 +96,18 @@ struct AlgoGaugeDetails{
 	PERF Perf = perfOFF;
     bool Json = false;
     std::string FileWritePath = "";
+    Output::Format Format = Output::json; // How the results are written to STDOUT and the file
 	bool Unique = false;
+	uint64_t Seed = 0; // Every sorting algorithm generates its values from this seed
+	RandomGenerator Generator = philox;
+	unsigned int Repeat = 1; // Timed runs of every C++ sorting algorithm
+	unsigned int Warmup = 0; // Untimed runs of every C++ sorting algorithm before the timed ones
+	Timing::Clock Timer = Timing::steadyClock; // The clock every C++ benchmark is timed with
+	std::vector<unsigned int> PinCpus; // CPUs the program is pinned to. Empty leaves it wherever the scheduler puts it
+	bool Isolate = false; // Also raise the priority and lock memory
+	bool Profile = false; // Sample where every C++ sort spends its cycles and cache misses
+	unsigned int ProfileFrequency = 4000; // Samples per second of each event
+	bool CountOperations = false; // Count the comparisons, swaps, moves and allocations of every C++ sort
 	std::vector<SortingAlgorithmSettings> SelectedSortingAlgorithms;
 	std::vector<HashTableSettings> SelectedHashTables;
 	std::vector<CRUDOperationSettings> SelectedCRUDOperations;
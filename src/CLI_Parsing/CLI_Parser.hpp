@@ -60,21 +60,34 @@ Options getOptions(string type) {
         ("o,output", "Will output the arrays in the output. It is highly recommended to use a small length (less than 100).", cxxopts::value<bool>()->implicit_value("true"))
         ("h,help", "Prints this help page.")
         ("p,perf", "Includes Perf data in the output.", cxxopts::value<bool>()->implicit_value("true"))
+        ("perf-grouped", "Includes Perf data like --perf, but the hardware counters are measured in groups that fit the CPU's counter registers, one group per --repeat run, so counters that are divided by each other (like instructions and cycles) are never multiplexed apart. Every counter is averaged over the runs it was measured in.", cxxopts::value<bool>()->implicit_value("true"))
         ("sample", "Return PERF sample (dummy) data data in the output.", cxxopts::value<bool>()->implicit_value("true"))
+        ("seed", "Seed for generating the sorting values. Every sorting algorithm uses the same seed. A random seed is picked if none is passed and is included in the output.", cxxopts::value<uint64_t>())
+        ("rng", "Random number generator for the sorting values. Options: philox, xoshiro256, pcg64, splitmix64, mt19937", cxxopts::value<string>()->default_value("philox"))
+        ("repeat", "Number of timed runs of every sorting algorithm (C++ only). Each run sorts the same values, and the median run time is reported along with the min, mean, standard deviation, 95th percentile and every run", cxxopts::value<unsigned int>()->default_value("1"))
+        ("warmup", "Number of untimed runs of every sorting algorithm before the timed runs (C++ only)", cxxopts::value<unsigned int>()->default_value("0"))
+        ("timer", "Clock to time the C++ benchmarks with. Options: steady (std::chrono::steady_clock), tsc (the CPU's tick counter: rdtscp on x86, cntvct on ARM. Calibrated at startup, with the cost of reading it taken off every time)", cxxopts::value<string>()->default_value("steady"))
+        ("pin-cpu", "Pins the program to a list of CPUs (like 2 or 4-7,12) so the scheduler can't move the benchmarks between cores. Parallel sorts default to one thread per pinned CPU. The frequency scaling governor of the CPUs is checked before every sort, and the context switches and CPU migrations during the timed runs are reported (Linux only)", cxxopts::value<string>())
+        ("isolate", "Pins the program like --pin-cpu (to the CPU it started on if --pin-cpu isn't passed), raises its scheduling priority and locks its memory so it can't be paged out. Raising the priority and locking memory need root (Linux only)", cxxopts::value<bool>()->implicit_value("true"))
+        ("profile", "Samples where every C++ sort spends its cycles and cache misses, and adds the functions and source lines that were sampled most to the output. Source lines need a build with -g, and callers need frame pointers (Linux only)", cxxopts::value<bool>()->implicit_value("true"))
+        ("profile-frequency", "Samples per second of each event with --profile", cxxopts::value<unsigned int>()->default_value("4000"))
+        ("count-ops", "Counts the comparisons, swaps, element moves and bytes allocated by every C++ sort, and adds them to the output. The sorts are compiled a second time for counting, so only runs with this option pay for it, but their run times are slower", cxxopts::value<bool>()->implicit_value("true"))
     ;
     // Adds the output settings group to allow the user to change where the output of the program should go
     options.add_options("Program Output [OPTIONAL]")
 
         ("f,file","The file path and name to output the file to",value<string>()->default_value(""),
-        "File path must include the file name (extension not required). Regardless of file extension, file content's structure will always be JSON.")
+        "File path must include the file name (extension not required). Regardless of file extension, file content's structure will always be JSON, unless another --format is chosen.")
 
         ("j,json", "Prints the output as a json formatted object", cxxopts::value<bool>()->implicit_value("true"), "Pass this flag if you want the STDOUT to be JSON formatted.")
 
+        ("format", "The format of the results written by --json and --file. Options: json, csv (one row per sort, with the perf counters as columns), columnar (the same table in a compact binary format stored a column at a time, also called binary). The tables only hold C++ sorts", cxxopts::value<string>()->default_value("json"))
+
     ;
 
     options.add_options("Algorithm Name and Length [REQUIRED]")
-        ("a,algo,probe,algorithm", "Sorting: [default, bubble, selection, insertion, quick, merge, heap]\nHash Table: [linear_probe]\nCRUD Operation: [push_front, push_back, pop_front, pop_back, pushpop_back, pushpop_front]", cxxopts::value<vector<string>>(), "Name of the algorithm to run.")
-        ("s, strat, type, strategy", "Sorting: [random, repeated, chunks, sorted, sorted_reversed]\nHash Table: [closed]\nCRUD Operation:[array, linked_list]", cxxopts::value<vector<std::string>>(), "Determines what type or strategy used in generating")
+        ("a,algo,probe,algorithm", "Sorting: [default, bubble, selection, insertion, quick, intro, block_quick, merge, buffered_merge, network_merge, tim, simd_bitonic, scalar_bitonic, heap, radix_lsd8, radix_lsd11, radix_lsd16, radix_msd, array_kmerge, heap_kmerge, loser_tree_kmerge, parallel_merge, parallel_quick]\nHash Table: [linear_probe]\nCRUD Operation: [push_front, push_back, pop_front, pop_back, pushpop_back, pushpop_front]", cxxopts::value<vector<string>>(), "Name of the algorithm to run.")
+        ("s, strat, type, strategy", "Sorting: [random, repeated, chunks, sorted, sorted_reversed, zipf, gaussian, nearly_sorted, organ_pipe, sawtooth, few_unique, file]\nHash Table: [closed]\nCRUD Operation:[array, linked_list]", cxxopts::value<vector<std::string>>(), "Determines what type or strategy used in generating")
         ("n, num, length, start, number", "Provide an int value between 0 and " + std::to_string(UINT32_MAX) + "\nSorting: Size of Array to Sort\nHash Table: Number of testing operations\nCRUD Operation: Number of operations", cxxopts::value<vector<int>>(), "Number of items the algorithm will process")
     ;
 
@@ -85,6 +98,13 @@ Options getOptions(string type) {
     options.add_options("Optional Sorting Algorithm")
         ("i, step,step_count, iterator", "How much the number per iteration", cxxopts::value<vector<int>>()->default_value("1"))
         ("e, end, additional", "The ending number for step operations",  cxxopts::value<vector<int>>()->default_value("0")) 
+        ("t, threads", "Number of threads a parallel sorting algorithm may use. 0 uses every CPU the program may run on", cxxopts::value<vector<int>>(), "Threads per parallel algorithm")
+        ("cutoff", "Range size at or below which a parallel sorting algorithm stops splitting work and sorts sequentially. 0 uses the algorithm's default", cxxopts::value<vector<int>>(), "Sequential cutoff per parallel algorithm")
+        ("k, kway", "Number of runs a K-way merge sort merges at once. Options: 2, 4, 8, 16, 32, 64", cxxopts::value<vector<int>>(), "K per K-way merge algorithm")
+        ("strategy-param", "Parameter for the sorting strategy: zipf skew (default 1.0), gaussian standard deviation as a fraction of the value range (default 0.1), nearly_sorted percent of values out of place (default 5), sawtooth period (default length / 16), few_unique number of distinct values (default 16). 0 uses the default", cxxopts::value<vector<double>>(), "Strategy parameter per sorting algorithm")
+        ("input-file", "Binary file of raw keys (in the machine's byte order, as --key-type) to sort with the file strategy. The first --number keys are used", cxxopts::value<vector<string>>(), "Input file per file strategy")
+        ("key-type", "Type of element to sort (C++ only). Options: uint32, uint64, float, double, string16, record16, record64", cxxopts::value<vector<string>>(), "Key type per sorting algorithm")
+        ("memory-policy", "How the sort's buffers are allocated (C++ on Linux only). Options: default, 4k, thp (transparent huge pages), hugetlb (explicit 2M pages, falls back to thp), numa_local, numa_interleave", cxxopts::value<vector<string>>(), "Memory policy per sorting algorithm")
     ;
     options.add_options("Required CRUD Operation and Hash Table")
         ("c, capacity", "Provide a number (int > 0) that determines hash table, array, or linked list size .", cxxopts::value<vector<int>>(), "How many elements can be stored given strategy")
@@ -130,6 +150,8 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
 
     if (result["sample"].as<bool>()) {
         algogaugeDetails.Perf = sample;
+    } else if (result["perf-grouped"].as<bool>()) {
+        algogaugeDetails.Perf = perfGrouped;
     } else if (result["perf"].as<bool>()) {
         algogaugeDetails.Perf = perfON;
     } else {
@@ -137,8 +159,51 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
     }
 
     algogaugeDetails.Json = result["json"].as<bool>();
+    algogaugeDetails.Seed = result.count("seed") ? result["seed"].as<uint64_t>() : RandomNum<>::newSeed();
+
+    string generator = result["rng"].as<string>();
+    std::transform(generator.begin(), generator.end(), generator.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    auto generatorIt = randomGeneratorMap.find(generator);
+    if (generatorIt == randomGeneratorMap.end()) {
+        throw std::invalid_argument("There is no random number generator: " + generator);
+    }
+    algogaugeDetails.Generator = generatorIt->second;
+
+    algogaugeDetails.Repeat = result["repeat"].as<unsigned int>();
+    if (algogaugeDetails.Repeat == 0) {
+        throw std::invalid_argument("REPEAT must be at least 1");
+    }
+    algogaugeDetails.Warmup = result["warmup"].as<unsigned int>();
+
+    string timer = result["timer"].as<string>();
+    std::transform(timer.begin(), timer.end(), timer.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    auto timerIt = Timing::clockMap.find(timer);
+    if (timerIt == Timing::clockMap.end()) {
+        throw std::invalid_argument("There is no timer: " + timer);
+    }
+    algogaugeDetails.Timer = timerIt->second;
+
+    if (result.count("pin-cpu")) algogaugeDetails.PinCpus = Isolation::parseCpuList(result["pin-cpu"].as<string>());
+    algogaugeDetails.Isolate = result["isolate"].as<bool>();
+    algogaugeDetails.Profile = result["profile"].as<bool>();
+    algogaugeDetails.CountOperations = result["count-ops"].as<bool>();
+    algogaugeDetails.ProfileFrequency = result["profile-frequency"].as<unsigned int>();
+    if (algogaugeDetails.ProfileFrequency == 0) {
+        throw std::invalid_argument("PROFILE-FREQUENCY must be at least 1");
+    }
     algogaugeDetails.FileWritePath = result["file"].as<string>();
 
+    string format = result["format"].as<string>();
+    std::transform(format.begin(), format.end(), format.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    auto formatIt = Output::formatMap.find(format);
+    if (formatIt == Output::formatMap.end()) {
+        throw std::invalid_argument("There is no format: " + format);
+    }
+    algogaugeDetails.Format = formatIt->second;
+
 
     auto algorithmVector = result["algorithm"].as<std::vector<std::string>>();
     std::deque<std::string> algorithmDeque(algorithmVector.begin(), algorithmVector.end());
@@ -181,6 +246,48 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
         densityDeque.assign(densityVector->begin(), densityVector->end());
     }
 
+    auto threadsVector = result["threads"].as_optional<vector<int>>();
+    std::deque<int> threadsDeque;
+    if(threadsVector.has_value()){
+        threadsDeque.assign(threadsVector->begin(), threadsVector->end());
+    }
+
+    auto cutoffVector = result["cutoff"].as_optional<vector<int>>();
+    std::deque<int> cutoffDeque;
+    if(cutoffVector.has_value()){
+        cutoffDeque.assign(cutoffVector->begin(), cutoffVector->end());
+    }
+
+    auto kVector = result["kway"].as_optional<vector<int>>();
+    std::deque<int> kDeque;
+    if(kVector.has_value()){
+        kDeque.assign(kVector->begin(), kVector->end());
+    }
+
+    auto strategyParamVector = result["strategy-param"].as_optional<vector<double>>();
+    std::deque<double> strategyParamDeque;
+    if(strategyParamVector.has_value()){
+        strategyParamDeque.assign(strategyParamVector->begin(), strategyParamVector->end());
+    }
+
+    auto inputFileVector = result["input-file"].as_optional<vector<string>>();
+    std::deque<std::string> inputFileDeque;
+    if(inputFileVector.has_value()){
+        inputFileDeque.assign(inputFileVector->begin(), inputFileVector->end());
+    }
+
+    auto keyTypeVector = result["key-type"].as_optional<vector<string>>();
+    std::deque<std::string> keyTypeDeque;
+    if(keyTypeVector.has_value()){
+        keyTypeDeque.assign(keyTypeVector->begin(), keyTypeVector->end());
+    }
+
+    auto memoryPolicyVector = result["memory-policy"].as_optional<vector<string>>();
+    std::deque<std::string> memoryPolicyDeque;
+    if(memoryPolicyVector.has_value()){
+        memoryPolicyDeque.assign(memoryPolicyVector->begin(), memoryPolicyVector->end());
+    }
+
     auto namesVector = result["name"].as_optional<vector<std::string>>();
     std::deque<std::string> namesDeque;
     if(namesVector.has_value()){
@@ -200,6 +307,14 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
         std::transform(algo.begin(), algo.end(), algo.begin(),
                        [](unsigned char c){ return std::tolower(c); });
     }
+    for(auto& keyType: keyTypeDeque){
+        std::transform(keyType.begin(), keyType.end(), keyType.begin(),
+                       [](unsigned char c){ return std::tolower(c); });
+    }
+    for(auto& policy: memoryPolicyDeque){
+        std::transform(policy.begin(), policy.end(), policy.begin(),
+                       [](unsigned char c){ return std::tolower(c); });
+    }
     for(auto& lang: languageDeque){
         std::transform(lang.begin(), lang.end(), lang.begin(),
                        [](unsigned char c){ return std::tolower(c); });
@@ -339,6 +454,50 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
                 newSortingAlgorithm.Name = namesDeque.front();
             }
 
+            if(!threadsDeque.empty()){
+                if(threadsDeque.front() < 0){
+                    throw std::invalid_argument("The number of THREADS can not be negative");
+                }
+                newSortingAlgorithm.Threads = threadsDeque.front();
+            }
+
+            if(!cutoffDeque.empty()){
+                if(cutoffDeque.front() < 0){
+                    throw std::invalid_argument("The CUTOFF can not be negative");
+                }
+                newSortingAlgorithm.Cutoff = cutoffDeque.front();
+            }
+
+            if(!kDeque.empty()){
+                // the K-way merges are only built for these, so anything else is refused before any sort runs
+                if(kDeque.front() < 2 || kDeque.front() > 64 || (kDeque.front() & (kDeque.front() - 1)) != 0){
+                    throw std::invalid_argument("K must be one of 2, 4, 8, 16, 32 or 64 for a K-way merge. Got: " + std::to_string(kDeque.front()));
+                }
+                newSortingAlgorithm.K = kDeque.front();
+            }
+
+            if(!strategyParamDeque.empty()){
+                if(strategyParamDeque.front() < 0){
+                    throw std::invalid_argument("The STRATEGY PARAMETER can not be negative");
+                }
+                newSortingAlgorithm.StrategyParameter = strategyParamDeque.front();
+            }
+
+            if(!keyTypeDeque.empty()){
+                if(AlgoGauge::keyTypes.find(keyTypeDeque.front()) == AlgoGauge::keyTypes.end()){
+                    throw std::invalid_argument("There is no key type: " + keyTypeDeque.front());
+                }
+                newSortingAlgorithm.KeyType = keyTypeDeque.front();
+            }
+
+            if(!memoryPolicyDeque.empty()){
+                auto policyIt = Allocation::policyMap.find(memoryPolicyDeque.front());
+                if(policyIt == Allocation::policyMap.end()){
+                    throw std::invalid_argument("There is no memory policy: " + memoryPolicyDeque.front());
+                }
+                newSortingAlgorithm.MemoryPolicy = policyIt->second;
+            }
+
             auto it = strategyMap.find(strategyDeque.front());
 
             if (it != strategyMap.end()) {
@@ -346,10 +505,21 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
             } else {
                 throw std::invalid_argument("There is no array strategy: " + strategyDeque.front());
             }
+
+            if(newSortingAlgorithm.ArrayStrategy == AlgoGauge::AlgorithmOptions::fileSet){
+                if(inputFileDeque.empty()){
+                    throw std::invalid_argument("Missing required options for algorithm: INPUT FILE per file strategy.");
+                }
+                newSortingAlgorithm.InputFile = inputFileDeque.front();
+            }
             
             algogaugeDetails.SelectedSortingAlgorithms.push_back(newSortingAlgorithm);
             
         }
+        // input files are only taken by algorithms that use the file strategy
+        if(!inputFileDeque.empty() && strategyDeque.front() == "file"){
+            inputFileDeque.pop_front();
+        }
         strategyDeque.pop_front();
         languageDeque.pop_front();
         numberDeque.pop_front();
@@ -359,6 +529,24 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
         if(!additionalDeque.empty()){
             additionalDeque.pop_front();
         }
+        if(!threadsDeque.empty()){
+            threadsDeque.pop_front();
+        }
+        if(!cutoffDeque.empty()){
+            cutoffDeque.pop_front();
+        }
+        if(!kDeque.empty()){
+            kDeque.pop_front();
+        }
+        if(!strategyParamDeque.empty()){
+            strategyParamDeque.pop_front();
+        }
+        if(!keyTypeDeque.empty()){
+            keyTypeDeque.pop_front();
+        }
+        if(!memoryPolicyDeque.empty()){
+            memoryPolicyDeque.pop_front();
+        }
         
 
         if(!namesDeque.empty()){
@@ -366,16 +554,33 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
         }
         continue;   
     }
+    checkSortingAlgorithms(algogaugeDetails);
 
     if(algogaugeDetails.Verbose){
-        std::string verboseOutput;
+        std::string verboseOutput = "Seed: " + std::to_string(algogaugeDetails.Seed)
+            + " generator: " + RandomGeneratorStrings[algogaugeDetails.Generator]
+            + " repeat: " + std::to_string(algogaugeDetails.Repeat)
+            + " warmup: " + std::to_string(algogaugeDetails.Warmup)
+            + " timer: " + Timing::ClockStrings[algogaugeDetails.Timer]
+            + " format: " + Output::FormatStrings[algogaugeDetails.Format]
+            + " pin_cpu: " + Isolation::toCpuList(algogaugeDetails.PinCpus)
+            + " isolate: " + (algogaugeDetails.Isolate ? "true" : "false")
+            + " count_ops: " + (algogaugeDetails.CountOperations ? "true" : "false")
+            + " profile: " + (algogaugeDetails.Profile ? std::to_string(algogaugeDetails.ProfileFrequency) + "Hz" : "false") + "\n";
         for(const auto& sorting: algogaugeDetails.SelectedSortingAlgorithms){
             std::ostringstream oss;
             oss << "Sorting Algorithm"
                 << " algorithm: " << sorting.Algorithm
                 << " array_length: " << sorting.ArrayLength
                 << " strategy: " << sorting.ArrayStrategyString
+                << " strategy_param: " << sorting.StrategyParameter
+                << " input_file: " << sorting.InputFile
                 << " language: " << sorting.Language
+                << " threads: " << sorting.Threads
+                << " cutoff: " << sorting.Cutoff
+                << " k: " << sorting.K
+                << " key_type: " << sorting.KeyType
+                << " memory_policy: " << Allocation::PolicyStrings[sorting.MemoryPolicy]
                 << " name: " << sorting.Name
                 << "\n"
             ;
@@ -414,7 +619,7 @@ AlgoGauge::AlgoGaugeDetails parseAndGetAlgorithms(const ParseResult& result, con
        
 #ifndef linux
     // raise warning if trying to use perf on non-linux system
-    if (algogaugeDetails.Perf == perfON) {
+    if (algogaugeDetails.Perf == perfON || algogaugeDetails.Perf == perfGrouped) {
         std::cerr << "Warning: PERF is not supported on this system. PERF functionality is only available on Linux distributions. The program will continue to run, but any PERF data will be replaced with sample (dummy) values. To avoid this warning, remove the 'p' or 'perf' option from your arguments, or add --sample to explicitly request dummy data." << std::endl;
     }
 #endif
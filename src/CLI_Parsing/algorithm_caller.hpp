@@ -9,6 +9,9 @@
 #include <assert.h>
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <set>
 
 #include "../AlgoGaugeDetails.hpp"
 #include "CLI_Parser.hpp"
@@ -17,6 +20,8 @@
 #include "../dependencies/PerfEvent.hpp"
 #include "../dependencies/subprocess.h"
 
+#include "../algorithms/ResultWriter.hpp"
+
 #include "../algorithms/sort_7algs.cpp"
 #include "../algorithms/hash_algs.cpp"
 
@@ -27,34 +32,172 @@
 
 
 /**
- * Method for determining which Sorting Algorithm to return
+ * Keeps a pristine copy of each dataset that more than one sorting algorithm in a batch sorts, so it is generated
+ * once and every algorithm sorts the identical input. Datasets are identified by everything they are generated from.
+ * Each copy is dropped after its last use, so a batch only ever holds the datasets it still needs
+ */
+class DatasetCache {
+public:
+    /**
+     * @return Whether datasets made with a strategy are worth caching. --input-file datasets aren't: mapping the file
+     * again is as cheap as copying it, and a copy would hold a second set of the values in memory
+     */
+    static bool caches(const AlgoGauge::AlgorithmOptions& strategy) { return strategy != AlgoGauge::AlgorithmOptions::fileSet; }
+
+    static std::string makeKey(
+        const string& keyType,
+        const AlgoGauge::AlgorithmOptions& strategy,
+        const double& strategyParameter,
+        const unsigned int& length,
+        const string& inputFile,
+        const uint64_t& seed,
+        const RandomGenerator& generator
+    ) {
+        std::ostringstream key;
+        key << keyType << '|' << strategy << '|' << strategyParameter << '|' << length << '|' << inputFile << '|' << seed << '|' << generator;
+        return key.str();
+    }
+
+    /**
+     * Registers one upcoming use of a dataset. Must be called for every use before the batch runs
+     */
+    void expect(const std::string& key) { entries[key].usesLeft++; }
+
+    /**
+     * @return The cached dataset for the key, or nullptr if it hasn't been generated yet
+     */
+    const std::vector<unsigned char>* find(const std::string& key, double& strategyParameter) const {
+        auto it = entries.find(key);
+        if (it == entries.end() || it->second.values.empty()) return nullptr;
+        strategyParameter = it->second.strategyParameter;
+        return &it->second.values;
+    }
+
+    /**
+     * Saves a copy of a freshly generated dataset, if anything after this use still needs it
+     */
+    void store(const std::string& key, const void* values, size_t bytes, const double& strategyParameter) {
+        auto it = entries.find(key);
+        if (it == entries.end() || it->second.usesLeft < 2) return;
+        const auto* first = static_cast<const unsigned char*>(values);
+        it->second.values.assign(first, first + bytes);
+        it->second.strategyParameter = strategyParameter;
+    }
+
+    /**
+     * Marks one use of a dataset as done, and frees it after the last one
+     */
+    void release(const std::string& key) {
+        auto it = entries.find(key);
+        if (it != entries.end() && --it->second.usesLeft == 0) entries.erase(it);
+    }
+
+private:
+    struct Entry {
+        std::vector<unsigned char> values;
+        double strategyParameter = 0;
+        unsigned int usesLeft = 0;
+    };
+    std::unordered_map<std::string, Entry> entries;
+};
+
+/**
+ * The names runCPlusPlusSort() builds a sort for
+ */
+const std::set<std::string> cPlusPlusSorts = {
+	"default", "bubble", "selection", "insertion", "quick", "intro", "block_quick", "merge", "buffered_merge",
+	"network_merge", "tim", "simd_bitonic", "scalar_bitonic", "heap", "radix_lsd8", "radix_lsd11", "radix_lsd16",
+	"radix_msd", "array_kmerge", "heap_kmerge", "loser_tree_kmerge", "parallel_quick", "parallel_merge"
+};
+
+/**
+ * Builds, loads and runs one sorting algorithm for a single key type. Called by runCPlusPlusProgram() once it has
+ * picked T from the --key-type name
+ * @tparam T The element type to sort
+ * @param writer Where to write the result of the sort
  * @param algorithmName The name of the algorithm to return (must match exactly from a set of names)
  * @param length The cardinality of the initial set to produce for the algorithm to sort
  * @param canonicalName A human-readable name to help keep track of the algorithm
  * @param verbose Whether or not all output should be included in STD::0UT
  * @param includeValues Whether or not the initial set and final set should be included in the output
  * @param includePerf Whether or not this should include Perf metrics within the output
- * @return A sorting algorithm object
+ * @param threads The number of threads a parallel algorithm may use (0 uses every CPU the program may run on)
+ * @param cutoff The range size at which a parallel algorithm switches to sequential sorting (0 uses its default)
+ * @param k The number of runs a K-way merge algorithm merges at once
+ * @param strategyParameter The parameter for ArrayStrategy, for the strategies that take one (0 uses its default)
+ * @param inputFile The file to load the values from, for the file strategy
+ * @param seed The seed to generate the values from
+ * @param generator The random number generator to generate the values with
+ * @param memoryPolicy How the sort's buffers are allocated
+ * @param repeat The number of timed runs
+ * @param warmup The number of untimed runs before the timed ones
+ * @param cache Where to share the generated values with the rest of the batch (nullptr to always generate them)
  */
-std::string runCPlusPlusProgram(
-    string algorithmName, // Opting for this to be a string and NOT an enum as we can just pass what the user passes as the --algo arg directly and return an error if it doesn't match any algorithms
+template<typename T>
+void runCPlusPlusSort(
+    Output::ResultWriter& writer,
+    const string& algorithmName,
     const unsigned int& length,
 	const AlgoGauge::AlgorithmOptions& ArrayStrategy,
-
-    const string& canonicalName = "",
-    const bool& verbose = false,
-    const bool& includeValues = false,
-    const AlgoGauge::PERF& includePerf = perfOFF
+    const string& canonicalName,
+    const bool& verbose,
+    const bool& includeValues,
+    const AlgoGauge::PERF& includePerf,
+    const unsigned int& threads,
+    const unsigned int& cutoff,
+    const unsigned int& k,
+    const double& strategyParameter,
+    const string& inputFile,
+    const uint64_t& seed,
+    const RandomGenerator& generator,
+    const Allocation::Policy& memoryPolicy,
+    const unsigned int& repeat,
+    const unsigned int& warmup,
+    DatasetCache* cache
 ) {
-	std::unique_ptr<Sorting::BaseSort<unsigned int>> SortingAlgorithm;
+	std::unique_ptr<Sorting::BaseSort<T>> SortingAlgorithm;
 	// std::cout << includePerf << "perf";
     //Essentially this is a switch case block that determines which algorithm to create and return
-	if (algorithmName == "bubble" || algorithmName == "default") SortingAlgorithm = std::make_unique<Sorting::Bubble<unsigned int>>(length, canonicalName, verbose, includeValues, includePerf);
-    else if (algorithmName == "selection") SortingAlgorithm = std::make_unique<Sorting::Selection<unsigned int>>(length, canonicalName, verbose, includeValues, includePerf);
-    else if (algorithmName == "insertion") SortingAlgorithm = std::make_unique<Sorting::Insertion<unsigned int>>(length, canonicalName, verbose, includeValues, includePerf);
-    else if (algorithmName == "quick") SortingAlgorithm = std::make_unique<Sorting::Quick<unsigned int>>(length, canonicalName, verbose, includeValues, includePerf);
-    else if (algorithmName == "merge") SortingAlgorithm = std::make_unique<Sorting::Merge<unsigned int>>(length, canonicalName, verbose, includeValues, includePerf);
-    else if (algorithmName == "heap") SortingAlgorithm = std::make_unique<Sorting::Heap<unsigned int>>(length, canonicalName, verbose, includeValues, includePerf);
+	if (algorithmName == "bubble" || algorithmName == "default") SortingAlgorithm = std::make_unique<Sorting::Bubble<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "selection") SortingAlgorithm = std::make_unique<Sorting::Selection<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "insertion") SortingAlgorithm = std::make_unique<Sorting::Insertion<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "quick") SortingAlgorithm = std::make_unique<Sorting::Quick<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "intro") SortingAlgorithm = std::make_unique<Sorting::Intro<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "block_quick") SortingAlgorithm = std::make_unique<Sorting::BlockQuick<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "merge") SortingAlgorithm = std::make_unique<Sorting::Merge<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "buffered_merge") SortingAlgorithm = std::make_unique<Sorting::BufferedMerge<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "network_merge") {
+        // the sorting network kernels only work on unsigned 32 bit ints
+        if constexpr (std::is_same<T, unsigned int>::value) SortingAlgorithm = std::make_unique<Sorting::BufferedMerge<T, true>>(length, canonicalName, verbose, includeValues, includePerf);
+        else if constexpr (KeyTypes::IsCounted<T>::value) throw std::invalid_argument("Algorithm \"" + algorithmName + "\" can't count its operations, as its sorting network works on the raw ints!");
+        else throw std::invalid_argument("Algorithm \"" + algorithmName + "\" only supports the uint32 key type!");
+    }
+    else if (algorithmName == "tim") SortingAlgorithm = std::make_unique<Sorting::Tim<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "simd_bitonic" || algorithmName == "scalar_bitonic") {
+        // the sorting network kernels only work on unsigned 32 bit ints
+        if constexpr (std::is_same<T, unsigned int>::value) {
+            if (algorithmName == "simd_bitonic") SortingAlgorithm = std::make_unique<Sorting::Bitonic<T>>(length, canonicalName, verbose, includeValues, includePerf);
+            else SortingAlgorithm = std::make_unique<Sorting::Bitonic<T>>(length, canonicalName, verbose, includeValues, includePerf, SortingNetworks::scalar);
+        }
+        else if constexpr (KeyTypes::IsCounted<T>::value) throw std::invalid_argument("Algorithm \"" + algorithmName + "\" can't count its operations, as its sorting network works on the raw ints!");
+        else throw std::invalid_argument("Algorithm \"" + algorithmName + "\" only supports the uint32 key type!");
+    }
+    else if (algorithmName == "heap") SortingAlgorithm = std::make_unique<Sorting::Heap<T>>(length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName.rfind("radix_", 0) == 0) {
+        if constexpr (KeyTypes::KeyTraits<T>::hasRadixKey) {
+            if (algorithmName == "radix_lsd8") SortingAlgorithm = std::make_unique<Sorting::LSDRadix<T, 8>>(length, canonicalName, verbose, includeValues, includePerf);
+            else if (algorithmName == "radix_lsd11") SortingAlgorithm = std::make_unique<Sorting::LSDRadix<T, 11>>(length, canonicalName, verbose, includeValues, includePerf);
+            else if (algorithmName == "radix_lsd16") SortingAlgorithm = std::make_unique<Sorting::LSDRadix<T, 16>>(length, canonicalName, verbose, includeValues, includePerf);
+            else if (algorithmName == "radix_msd") SortingAlgorithm = std::make_unique<Sorting::MSDRadix<T>>(length, canonicalName, verbose, includeValues, includePerf);
+            else throw std::invalid_argument("Algorithm name \"" + algorithmName + "\" is not listed as a valid algorithm!");
+        }
+        else throw std::invalid_argument("Algorithm \"" + algorithmName + "\" can't sort the " + KeyTypes::KeyTraits<T>::name + " key type!");
+    }
+    else if (algorithmName == "array_kmerge") SortingAlgorithm = Sorting::makeKWayMerge<Sorting::ArrayKMerge, T>(k, length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "heap_kmerge") SortingAlgorithm = Sorting::makeKWayMerge<Sorting::HeapKMerge, T>(k, length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "loser_tree_kmerge") SortingAlgorithm = Sorting::makeKWayMerge<Sorting::LoserTreeKMerge, T>(k, length, canonicalName, verbose, includeValues, includePerf);
+    else if (algorithmName == "parallel_quick") SortingAlgorithm = std::make_unique<Sorting::ParallelQuick<T>>(length, canonicalName, verbose, includeValues, includePerf, threads, cutoff);
+    else if (algorithmName == "parallel_merge") SortingAlgorithm = std::make_unique<Sorting::ParallelMerge<T>>(length, canonicalName, verbose, includeValues, includePerf, threads);
     //raise an error if passed algorithmName doesn't match any already existing classes
     else throw std::invalid_argument("Algorithm name \"" + algorithmName + "\" is not listed as a valid algorithm!");
     // if (algorithmName == "bubble" || algorithmName == "default") SortingAlgorithm = new Sorting::Bubble<unsigned int>(length, canonicalName, verbose, includeValues, includePerf);
@@ -66,7 +209,17 @@ std::string runCPlusPlusProgram(
     // //raise an error if passed algorithmName doesn't match any already existing classes
     // else throw std::invalid_argument("Algorithm name \"" + algorithmName + "\" is not listed as a valid algorithm!");
 
-	switch (ArrayStrategy) {
+	SortingAlgorithm->setSeed(seed, generator);
+	if (memoryPolicy != Allocation::systemDefault) SortingAlgorithm->setMemoryPolicy(memoryPolicy);
+	SortingAlgorithm->setRepetitions(repeat, warmup);
+
+	if (!DatasetCache::caches(ArrayStrategy)) cache = nullptr;
+	const std::string datasetKey = DatasetCache::makeKey(KeyTypes::KeyTraits<T>::name, ArrayStrategy, strategyParameter, length, inputFile, seed, generator);
+	double cachedParameter = 0;
+	const std::vector<unsigned char>* cachedValues = cache ? cache->find(datasetKey, cachedParameter) : nullptr;
+	if (cachedValues) {
+		SortingAlgorithm->loadCachedValues(reinterpret_cast<const T*>(cachedValues->data()), ArrayStrategy, cachedParameter, inputFile);
+	} else switch (ArrayStrategy) {
 		case AlgoGauge::AlgorithmOptions::repeatedSet:
 			SortingAlgorithm->loadRepeatedValues();
 			break;
@@ -82,21 +235,166 @@ std::string runCPlusPlusProgram(
 		case AlgoGauge::AlgorithmOptions::randomSet:
 			SortingAlgorithm->loadRandomValues();
 			break;
+		case AlgoGauge::AlgorithmOptions::zipfSet:
+			SortingAlgorithm->loadZipfValues(strategyParameter);
+			break;
+		case AlgoGauge::AlgorithmOptions::gaussianSet:
+			SortingAlgorithm->loadGaussianValues(strategyParameter);
+			break;
+		case AlgoGauge::AlgorithmOptions::nearlySortedSet:
+			SortingAlgorithm->loadNearlySortedValues(strategyParameter);
+			break;
+		case AlgoGauge::AlgorithmOptions::organPipeSet:
+			SortingAlgorithm->loadOrganPipeValues();
+			break;
+		case AlgoGauge::AlgorithmOptions::sawtoothSet:
+			SortingAlgorithm->loadSawtoothValues(strategyParameter);
+			break;
+		case AlgoGauge::AlgorithmOptions::fewUniqueSet:
+			SortingAlgorithm->loadFewUniqueValues(strategyParameter);
+			break;
+		case AlgoGauge::AlgorithmOptions::fileSet:
+			SortingAlgorithm->loadFileValues(inputFile);
+			break;
 		default:
 			throw std::invalid_argument("Need to provide a valid Algorithm Option!");
 	}
+	if (cache) {
+		if (!cachedValues) cache->store(datasetKey, SortingAlgorithm->returnValues(), size_t(length) * sizeof(T), SortingAlgorithm->getStrategyParameter());
+		cache->release(datasetKey);
+	}
 
 	SortingAlgorithm->runAndCaptureSort();	
 
 	if (verbose) cout << SortingAlgorithm->getStringResult() << endl;
-	const std::string jsonDetails = SortingAlgorithm->getJSONResult() + ",";
+	if (writer.getFormat() == Output::json) SortingAlgorithm->writeJSONResult(writer.json());
+	else writer.writeRow(SortingAlgorithm->getResultRow());
 
 	// delete SortingAlgorithm;
 	// SortingAlgorithm.reset();
+}
+
+/**
+ * Runs the sort on T, or on KeyTypes::Counted<T> when its operations are counted. Counted is a separate
+ * instantiation, so sorts that aren't counted run exactly the same code as before
+ * @tparam T The element type to sort
+ * @param writer Where to write the result of the sort
+ * @param countOperations Whether to count the sort's comparisons, swaps, moves and allocations
+ * @param arguments The rest of runCPlusPlusSort's arguments
+ */
+template<typename T, typename... Arguments>
+void runCPlusPlusSortCounted(Output::ResultWriter& writer, const bool& countOperations, const Arguments&... arguments) {
+	if (countOperations) runCPlusPlusSort<KeyTypes::Counted<T>>(writer, arguments...);
+	else runCPlusPlusSort<T>(writer, arguments...);
+}
+
+/**
+ * Method for determining which Sorting Algorithm to return
+ * @param writer Where to write the result of the sort
+ * @param algorithmName The name of the algorithm to return (must match exactly from a set of names)
+ * @param length The cardinality of the initial set to produce for the algorithm to sort
+ * @param canonicalName A human-readable name to help keep track of the algorithm
+ * @param verbose Whether or not all output should be included in STD::0UT
+ * @param includeValues Whether or not the initial set and final set should be included in the output
+ * @param includePerf Whether or not this should include Perf metrics within the output
+ * @param threads The number of threads a parallel algorithm may use (0 uses every CPU the program may run on)
+ * @param cutoff The range size at which a parallel algorithm switches to sequential sorting (0 uses its default)
+ * @param k The number of runs a K-way merge algorithm merges at once
+ * @param keyType The type of element to sort (one of AlgoGauge::keyTypes)
+ * @param strategyParameter The parameter for ArrayStrategy, for the strategies that take one (0 uses its default)
+ * @param inputFile The file to load the values from, for the file strategy
+ * @param seed The seed to generate the values from
+ * @param generator The random number generator to generate the values with
+ * @param memoryPolicy How the sort's buffers are allocated
+ * @param repeat The number of timed runs
+ * @param warmup The number of untimed runs before the timed ones
+ * @param countOperations Whether to count the sort's comparisons, swaps, moves and allocations
+ * @param cache Where to share the generated values with the rest of the batch (nullptr to always generate them)
+ */
+void runCPlusPlusProgram(
+    Output::ResultWriter& writer,
+    string algorithmName, // Opting for this to be a string and NOT an enum as we can just pass what the user passes as the --algo arg directly and return an error if it doesn't match any algorithms
+    const unsigned int& length,
+	const AlgoGauge::AlgorithmOptions& ArrayStrategy,
+
+    const string& canonicalName = "",
+    const bool& verbose = false,
+    const bool& includeValues = false,
+    const AlgoGauge::PERF& includePerf = perfOFF,
+    const unsigned int& threads = 0,
+    const unsigned int& cutoff = 0,
+    const unsigned int& k = 2,
+    const string& keyType = "uint32",
+    const double& strategyParameter = 0,
+    const string& inputFile = "",
+    const uint64_t& seed = RandomNum<>::newSeed(),
+    const RandomGenerator& generator = philox,
+    const Allocation::Policy& memoryPolicy = Allocation::systemDefault,
+    const unsigned int& repeat = 1,
+    const unsigned int& warmup = 0,
+    const bool& countOperations = false,
+    DatasetCache* cache = nullptr
+) {
+	if (keyType == "uint32") runCPlusPlusSortCounted<unsigned int>(writer, countOperations, algorithmName, length, ArrayStrategy, canonicalName, verbose, includeValues, includePerf, threads, cutoff, k, strategyParameter, inputFile, seed, generator, memoryPolicy, repeat, warmup, cache);
+	else if (keyType == "uint64") runCPlusPlusSortCounted<uint64_t>(writer, countOperations, algorithmName, length, ArrayStrategy, canonicalName, verbose, includeValues, includePerf, threads, cutoff, k, strategyParameter, inputFile, seed, generator, memoryPolicy, repeat, warmup, cache);
+	else if (keyType == "float") runCPlusPlusSortCounted<float>(writer, countOperations, algorithmName, length, ArrayStrategy, canonicalName, verbose, includeValues, includePerf, threads, cutoff, k, strategyParameter, inputFile, seed, generator, memoryPolicy, repeat, warmup, cache);
+	else if (keyType == "double") runCPlusPlusSortCounted<double>(writer, countOperations, algorithmName, length, ArrayStrategy, canonicalName, verbose, includeValues, includePerf, threads, cutoff, k, strategyParameter, inputFile, seed, generator, memoryPolicy, repeat, warmup, cache);
+	else if (keyType == "string16") runCPlusPlusSortCounted<KeyTypes::FixedString<16>>(writer, countOperations, algorithmName, length, ArrayStrategy, canonicalName, verbose, includeValues, includePerf, threads, cutoff, k, strategyParameter, inputFile, seed, generator, memoryPolicy, repeat, warmup, cache);
+	else if (keyType == "record16") runCPlusPlusSortCounted<KeyTypes::Record<16>>(writer, countOperations, algorithmName, length, ArrayStrategy, canonicalName, verbose, includeValues, includePerf, threads, cutoff, k, strategyParameter, inputFile, seed, generator, memoryPolicy, repeat, warmup, cache);
+	else if (keyType == "record64") runCPlusPlusSortCounted<KeyTypes::Record<64>>(writer, countOperations, algorithmName, length, ArrayStrategy, canonicalName, verbose, includeValues, includePerf, threads, cutoff, k, strategyParameter, inputFile, seed, generator, memoryPolicy, repeat, warmup, cache);
+	else throw std::invalid_argument("Key type \"" + keyType + "\" is not listed as a valid key type!");
+}
+
 
-	return jsonDetails;
+/**
+ * Checks the settings of one C++ sort for T that runCPlusPlusSort() would otherwise only reject once the sorts
+ * before it had already written their results
+ * @tparam T The element type the sort would sort
+ * @param algo The sort's settings
+ * @param countOperations Whether its operations would be counted
+ * @throws std::invalid_argument if the sort can't be run as asked
+ */
+template<typename T>
+void checkCPlusPlusSort(const AlgoGauge::SortingAlgorithmSettings& algo, const bool& countOperations) {
+	const string& algorithmName = algo.Algorithm;
+	if (cPlusPlusSorts.count(algorithmName) == 0) throw std::invalid_argument("Algorithm name \"" + algorithmName + "\" is not listed as a valid algorithm!");
+	if (algorithmName == "simd_bitonic" || algorithmName == "scalar_bitonic" || algorithmName == "network_merge") {
+		if (!std::is_same<T, unsigned int>::value) throw std::invalid_argument("Algorithm \"" + algorithmName + "\" only supports the uint32 key type!");
+		if (countOperations) throw std::invalid_argument("Algorithm \"" + algorithmName + "\" can't count its operations, as its sorting network works on the raw ints!");
+	}
+	if (algorithmName.rfind("radix_", 0) == 0 && !KeyTypes::KeyTraits<T>::hasRadixKey) {
+		throw std::invalid_argument("Algorithm \"" + algorithmName + "\" can't sort the " + KeyTypes::KeyTraits<T>::name + " key type!");
+	}
+	if (algo.ArrayStrategy == AlgoGauge::AlgorithmOptions::fileSet) {
+		std::ifstream file(algo.InputFile, std::ios::binary | std::ios::ate);
+		if (algo.InputFile.empty() || !file) throw std::invalid_argument("Could not open the input file: " + algo.InputFile);
+		if (uint64_t(file.tellg()) < uint64_t(algo.ArrayLength) * sizeof(T)) {
+			throw std::invalid_argument("The input file " + algo.InputFile + " holds fewer than " + std::to_string(algo.ArrayLength)
+										+ " values of " + std::to_string(sizeof(T)) + " bytes");
+		}
+	}
 }
 
+/**
+ * Checks every C++ sort before any of them runs, so settings that can't work are reported before the first result
+ * is written rather than part way through the results
+ * @param algorithmsController The parsed settings
+ * @throws std::invalid_argument for the first sort that can't be run as asked
+ */
+void checkSortingAlgorithms(const AlgoGauge::AlgoGaugeDetails& algorithmsController) {
+	for (const auto& algo : algorithmsController.SelectedSortingAlgorithms) {
+		if (algo.Language != "c++") continue;
+		const bool& countOperations = algorithmsController.CountOperations;
+		if (algo.KeyType == "uint32") checkCPlusPlusSort<unsigned int>(algo, countOperations);
+		else if (algo.KeyType == "uint64") checkCPlusPlusSort<uint64_t>(algo, countOperations);
+		else if (algo.KeyType == "float") checkCPlusPlusSort<float>(algo, countOperations);
+		else if (algo.KeyType == "double") checkCPlusPlusSort<double>(algo, countOperations);
+		else if (algo.KeyType == "string16") checkCPlusPlusSort<KeyTypes::FixedString<16>>(algo, countOperations);
+		else if (algo.KeyType == "record16") checkCPlusPlusSort<KeyTypes::Record<16>>(algo, countOperations);
+		else if (algo.KeyType == "record64") checkCPlusPlusSort<KeyTypes::Record<64>>(algo, countOperations);
+		else throw std::invalid_argument("Key type \"" + algo.KeyType + "\" is not listed as a valid key type!");
+	}
+}
 
 std::string printChildProcessSTDOUT(struct subprocess_s &process, const std::string& perfDetails){
 	std::string jsonString;
@@ -151,7 +449,7 @@ std::string printChildProcessSTDOUT(struct subprocess_s &process, const std::str
 
 std::string runChildProcess(const char* commandLineArguments[], const char* environment[], const bool& verbose, const AlgoGauge::PERF perfAlgo){
 	if(verbose) std::cout << "________________ STARTED ________________" << std::endl;
-	const bool perf = (perfAlgo == perfON || perfAlgo == sample ? true: false);
+	const bool perf = (perfAlgo == perfON || perfAlgo == perfGrouped || perfAlgo == sample ? true: false);
  	struct subprocess_s process;
 	int exit_code;
 	std::string stdJSON = "";
@@ -271,28 +569,82 @@ std::string runChildProcess(const char* commandLineArguments[], const char* envi
 }
 
 
-std::string runSortingAlgorithms(const AlgoGauge::AlgoGaugeDetails& algorithmsController){
-	std::string jsonResults;
+/**
+ * Writes other languages' results as elements of the array being written. Each result already ends in a comma
+ */
+void writeChildProcessJSON(Output::JSONWriter& writer, std::string json){
+	while (!json.empty() && (json.back() == ',' || std::isspace(static_cast<unsigned char>(json.back())))) json.pop_back();
+	if (!json.empty()) writer.raw(json);
+}
+
+void runSortingAlgorithms(Output::ResultWriter& writer, const AlgoGauge::AlgoGaugeDetails& algorithmsController){
+
+	// count how many C++ algorithms sort each dataset, so datasets used more than once are only generated once
+	DatasetCache datasetCache;
+	for(const auto& algo: algorithmsController.SelectedSortingAlgorithms){
+		if(algo.Language != "c++" || !DatasetCache::caches(algo.ArrayStrategy)) continue;
+		datasetCache.expect(DatasetCache::makeKey(algo.KeyType, algo.ArrayStrategy, algo.StrategyParameter, algo.ArrayLength, algo.InputFile, algorithmsController.Seed, algorithmsController.Generator));
+	}
+
 	for(auto algo: algorithmsController.SelectedSortingAlgorithms){
 
 		// std::transform(algo.Language.begin(), algo.Language.end(), algo.Language.begin(), ::tolower);
 		// std::transform(algo.Name.begin(), algo.Name.end(), algo.Name.begin(), ::tolower); // make input lowercase
 
 		if(algo.Language == "c++"){
-			jsonResults += runCPlusPlusProgram(
+			runCPlusPlusProgram(
+				writer,
 				algo.Algorithm, 
 				algo.ArrayLength, 
 				algo.ArrayStrategy,
 				algo.Name, 
 				algorithmsController.Verbose, 
 				algorithmsController.Output, 
-				algorithmsController.Perf);
+				algorithmsController.Perf,
+				algo.Threads,
+				algo.Cutoff,
+				algo.K,
+				algo.KeyType,
+				algo.StrategyParameter,
+				algo.InputFile,
+				algorithmsController.Seed,
+				algorithmsController.Generator,
+				algo.MemoryPolicy,
+				algorithmsController.Repeat,
+				algorithmsController.Warmup,
+				algorithmsController.CountOperations,
+				&datasetCache);
 			continue;
 		}
 		if(algorithmsController.Output){
 			std::cerr << "Output is not supported with languages besides C++" << endl;
 			continue;
 		}
+		if(writer.getFormat() != Output::json){
+			std::cerr << "The " << Output::FormatStrings[writer.getFormat()] << " format is not supported with languages besides C++, so only the JSON format can include " << algo.Language << " results" << endl;
+			continue;
+		}
+		if(algo.ArrayStrategy > AlgoGauge::AlgorithmOptions::sortedSet){
+			std::cerr << "The " << algo.ArrayStrategyString << " strategy is not supported with languages besides C++" << endl;
+			continue;
+		}
+		if(algorithmsController.Repeat > 1 || algorithmsController.Warmup > 0){
+			std::cerr << "Repeat and warmup are not supported with languages besides C++, so it will only run once" << endl;
+		}
+		if(algorithmsController.CountOperations){
+			std::cerr << "Operation counts are not supported with languages besides C++, so they will not be counted" << endl;
+		}
+		if(algorithmsController.Profile){
+			std::cerr << "Profiling is not supported with languages besides C++, so it will not be profiled" << endl;
+		}
+		if(algo.MemoryPolicy != Allocation::systemDefault){
+			std::cerr << "Memory policies are not supported with languages besides C++" << endl;
+			continue;
+		}
+		if(algo.KeyType != "uint32"){
+			std::cerr << "Key types besides uint32 are not supported with languages besides C++" << endl;
+			continue;
+		}
 
 		const std::string selectedSortingAlgorithm = "--algorithm=" + algo.Algorithm;
 
@@ -308,7 +660,7 @@ std::string runSortingAlgorithms(const AlgoGauge::AlgoGaugeDetails& algorithmsCo
 
 		
 
-		const std::string perf = algorithmsController.Perf == perfON || algorithmsController.Perf == sample  ? "--perf": "--ignore";
+		const std::string perf = algorithmsController.Perf == perfON || algorithmsController.Perf == perfGrouped || algorithmsController.Perf == sample  ? "--perf": "--ignore";
 		// const std::string output = "--output=false";
 
 
@@ -328,22 +680,19 @@ std::string runSortingAlgorithms(const AlgoGauge::AlgoGaugeDetails& algorithmsCo
 		
 
 		const char* program_arguments[] = {binaryPath.c_str(), selectedSortingAlgorithm.c_str(), selectedArrayStrategy.c_str(), selectedArrayLength.c_str(), selectedName.c_str(), output.c_str(), verbose.c_str(), includeJSON.c_str(), perf.c_str(), nullptr};
-		jsonResults += runChildProcess(program_arguments, environment, algorithmsController.Verbose, algorithmsController.Perf);
+		writeChildProcessJSON(writer.json(), runChildProcess(program_arguments, environment, algorithmsController.Verbose, algorithmsController.Perf));
 
 	}
-	// std::cout << "hello"<< jsonResults << std::endl;
-
-	return jsonResults;
 }
 
 
 
-std::string runHashTables(const AlgoGauge::AlgoGaugeDetails& algorithmsController){
-	std::string jsonResults;
+void runHashTables(Output::JSONWriter& writer, const AlgoGauge::AlgoGaugeDetails& algorithmsController){
 	std::string includePerf;
 	switch (algorithmsController.Perf)
 	{
 	case perfON:
+	case perfGrouped:
 		includePerf += "true";
 		break;
 	case perfOFF:
@@ -353,28 +702,23 @@ std::string runHashTables(const AlgoGauge::AlgoGaugeDetails& algorithmsControlle
 	}
 
 	for(auto algo: algorithmsController.SelectedHashTables){
-		jsonResults += runHash(HashTables::ClosedHashTable<string, string> (
+		writer.raw(runHash(HashTables::ClosedHashTable<string, string> (
 			algo.Capacity,
 			algo.Probe,
 			algo.Load,
 			algo.Number,
 			algorithmsController.Verbose,
 			includePerf
-		));
-
-		jsonResults+=",";
-
-
+		)));
 	}
-	return jsonResults;
 }
 
-std::string runCRUDOperation(const AlgoGauge::AlgoGaugeDetails& algorithmsController){
-	std::string jsonResults;
+void runCRUDOperation(Output::JSONWriter& writer, const AlgoGauge::AlgoGaugeDetails& algorithmsController){
 	std::string includePerf;
 	switch (algorithmsController.Perf)
 	{
 	case perfON:
+	case perfGrouped:
 		includePerf += "true";
 		break;
 	case perfOFF:
@@ -386,72 +730,152 @@ std::string runCRUDOperation(const AlgoGauge::AlgoGaugeDetails& algorithmsContro
 	for(auto algo: algorithmsController.SelectedCRUDOperations){
 		// cout << algo.Type << endl;
 		if(algo.Type == "array"){
-			jsonResults += ArrayPerformanceTest(
+			writer.raw(ArrayPerformanceTest(
 				algo.Size,
 				algo.Number,
 				algo.Operation,
 				includePerf,
 				algorithmsController.Verbose,
 				algorithmsController.Output
-			);
+			));
 		}else if(algo.Type == "linked_list"){
-			jsonResults += LinkedListPerformanceTest(
+			writer.raw(LinkedListPerformanceTest(
 				algo.Size,
 				algo.Number,
 				algo.Operation,
 				includePerf,
 				algorithmsController.Verbose,
 				algorithmsController.Output
-			);
+			));
 		}
-
-		jsonResults+=",";
 	}
-
-	return jsonResults;
 }
 
 
+/**
+ * Runs everything selected, writing the results in the chosen format as they are produced
+ * @param writer Where to write the results
+ * @param algorithmsController The parsed settings
+ */
+void writeResults(Output::ResultWriter& writer, const AlgoGauge::AlgoGaugeDetails& algorithmsController){
+	if (writer.getFormat() == Output::json) {
+		Output::JSONWriter &json = writer.json();
+		json.beginObject();
+		if(!algorithmsController.SelectedSortingAlgorithms.empty()){
+			json.key("sorting_algorithms").beginArray();
+			runSortingAlgorithms(writer, algorithmsController);
+			json.endArray();
+		}
+		if(!algorithmsController.SelectedHashTables.empty()){
+			json.key("hash_table").beginArray();
+			runHashTables(json, algorithmsController);
+			json.endArray();
+		}
+		if(!algorithmsController.SelectedCRUDOperations.empty()){
+			json.key("crud_operations").beginArray();
+			runCRUDOperation(json, algorithmsController);
+			json.endArray();
+		}
+		json.endObject();
+	} else {
+		// the table has one row per sort, so only sorts fit in it
+		if (!algorithmsController.SelectedHashTables.empty() || !algorithmsController.SelectedCRUDOperations.empty()) {
+			std::cerr << "Hash tables and CRUD operations are only supported with the JSON format, so they will not be run" << endl;
+		}
+		runSortingAlgorithms(writer, algorithmsController);
+	}
+}
+
 void processAlgorithms(const AlgoGauge::AlgoGaugeDetails& algorithmsController){
 	// int x = 7;
     // assert (x==5);
-	
-	std::string jsonResults = "{"; //create the json results object even if not specified
 
-	if(!algorithmsController.SelectedSortingAlgorithms.empty()){
-		jsonResults+= "\"sorting_algorithms\": [";
-		jsonResults += runSortingAlgorithms(algorithmsController);
-		jsonResults.pop_back(); //remove extraneous comma
-		jsonResults += "]";
+	Timing::Timer &timer = Timing::Timer::global();
+	timer.select(algorithmsController.Timer); // calibrated once, before anything is timed
+	if (algorithmsController.Verbose && timer.getClock() == Timing::tickCounter) {
+		cout << "Timing with the tick counter at " << timer.getTicksPerSecond() / 1e9 << " GHz, taking "
+			 << timer.getOverheadNanoseconds() << "ns off every time" << endl;
 	}
-	if(!algorithmsController.SelectedHashTables.empty()){
-		jsonResults += "\"hash_table\":[";
-		jsonResults += runHashTables(algorithmsController);
-		jsonResults.pop_back(); //remove extraneous comma
-		jsonResults += "]";
+	// before any sort is constructed, so the thread pools inherit the affinity and priority
+	Isolation::Isolator::global().apply(algorithmsController.PinCpus, algorithmsController.Isolate, algorithmsController.Verbose);
+	Profiling::settings() = {algorithmsController.Profile, algorithmsController.ProfileFrequency};
+
+	// the results are written as they are produced. If anything else prints to STDOUT along the way (verbose
+	// messages, printed values or other languages' output), the results are held in a temporary file until the end
+	// so the two don't interleave
+	bool sharesStdout = algorithmsController.Verbose || (algorithmsController.Output && !algorithmsController.SelectedCRUDOperations.empty());
+	for (const auto& algo : algorithmsController.SelectedSortingAlgorithms) sharesStdout |= algo.Language != "c++";
+
+	// a regular --file is written under a temporary name next to it, and only renamed over it once every result is
+	// in, so a run that fails part way leaves the previous results as they were
+	const std::string& filePath = algorithmsController.FileWritePath;
+	std::error_code statusError;
+	const auto fileStatus = std::filesystem::status(filePath, statusError);
+	const bool replacesFile = !filePath.empty() && (fileStatus.type() == std::filesystem::file_type::not_found || fileStatus.type() == std::filesystem::file_type::regular);
+	const std::string writePath = replacesFile ? filePath + ".partial" : filePath;
+
+	std::vector<std::FILE*> sinks;
+	std::unique_ptr<std::FILE, int (*)(std::FILE*)> heldResults(nullptr, std::fclose);
+	std::unique_ptr<std::FILE, int (*)(std::FILE*)> outFile(nullptr, std::fclose);
+	if (algorithmsController.Json) {
+		if (sharesStdout) heldResults.reset(std::tmpfile());
+		sinks.push_back(heldResults ? heldResults.get() : stdout);
 	}
-	if(!algorithmsController.SelectedCRUDOperations.empty()){
-		jsonResults += "\"crud_operations\":[";
-		jsonResults += runCRUDOperation(algorithmsController);
-		jsonResults.pop_back(); //remove extraneous comma
-		jsonResults += "]";
+	if (!filePath.empty()) { //print output to file
+		outFile.reset(std::fopen(writePath.c_str(), "wb"));
+		if (!outFile) throw std::invalid_argument("Could not open '" + writePath + "' to write the results to!");
+		sinks.push_back(outFile.get());
 	}
+	std::fflush(stdout); // anything printed so far goes first
+
+	const Output::Format format = algorithmsController.Format;
+	auto releaseStdout = [&]() {
+		if (heldResults) {
+			std::fflush(stdout);
+			std::rewind(heldResults.get());
+			char buffer[1 << 16];
+			size_t bytesRead;
+			while ((bytesRead = std::fread(buffer, 1, sizeof(buffer), heldResults.get())) > 0) std::fwrite(buffer, 1, bytesRead, stdout);
+		}
+		if (algorithmsController.Json && format == Output::json) std::fputc('\n', stdout);
+	};
+
+	Output::ResultWriter writer(format, sinks); //create the results even if not specified
+	try {
+		writeResults(writer, algorithmsController);
+		writer.finish();
+	} catch (...) {
+		// STDOUT gets what was written so far, closed off so it still parses. The --file is left as it was
+		try {
+			writer.abandon();
+		} catch (const std::exception&) {} // the error that stopped the run is the one worth reporting
+		releaseStdout();
+		if (replacesFile) {
+			outFile.reset();
+			std::remove(writePath.c_str());
+		}
+		throw;
+	}
+	releaseStdout();
 
-	jsonResults+="}";
-	
-
-	if (algorithmsController.Json) std::cout << jsonResults << endl;
-
-	if (!algorithmsController.FileWritePath.empty()) { //print output to file
-		std::ofstream outFile;
-		outFile.open(algorithmsController.FileWritePath);
-		outFile << jsonResults;
-		outFile.close();
-		if (algorithmsController.Verbose) cout << "Results written in JSON at: '" << algorithmsController.FileWritePath << "'" << endl;
+	if (outFile) {
+		const bool closed = std::fclose(outFile.release()) == 0;
+		if (replacesFile) {
+#if defined(_WIN32)
+			if (closed) std::remove(filePath.c_str()); // rename() won't replace a file on Windows
+#endif
+			if (!closed || std::rename(writePath.c_str(), filePath.c_str()) != 0) {
+				std::remove(writePath.c_str());
+				throw std::runtime_error("Could not finish writing '" + filePath + "'");
+			}
+		}
+		else if (!closed) throw std::runtime_error("Could not finish writing '" + filePath + "'");
+		if (algorithmsController.Verbose) cout << "Results written in " << Output::FormatStrings[format] << " at: '" << filePath << "'" << endl;
 	}
 
 
-    cout << endl;
+	// not after a table on STDOUT, where it would be read as part of the table
+	if (format == Output::json || !algorithmsController.Json) cout << endl;
 }
 
 
@@ -0,0 +1,196 @@
+/**
+ * @brief Allocates the sort buffers with a chosen page size and NUMA placement. With a billion values a sort touches
+ * gigabytes of memory, so TLB misses on 4K pages and reads from a remote NUMA node can cost as much as the comparisons.
+ * Running the same sort under each policy shows how much. Only Linux supports the policies, everywhere else the
+ * buffers come from operator new.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_ALLOCATION_HPP
+#define ALGOGAUGE_ALLOCATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+#if defined(__linux__)
+#define ALGOGAUGE_LINUX_ALLOCATION 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Allocation {
+
+    /**
+     * @brief How a buffer's memory is mapped
+     */
+    enum Policy {
+        systemDefault = 0, // operator new, with whatever page size and placement the system picks
+        smallPages, // 4K pages only. Transparent huge pages are turned off for the buffer
+        transparentHugePages, // 2M aligned and madvise(MADV_HUGEPAGE), so the kernel backs it with huge pages when it can
+        hugePages, // explicit 2M pages (MAP_HUGETLB) from the reserved pool. Falls back to transparentHugePages
+        numaLocal, // 4K pages placed on the NUMA node of the thread that allocated the buffer
+        numaInterleave // 4K pages spread round robin over every NUMA node
+    };
+
+    static const std::string PolicyStrings[] = {
+            "default",
+            "4k",
+            "thp",
+            "hugetlb",
+            "numa_local",
+            "numa_interleave"
+    };
+
+    const std::unordered_map<std::string, Policy> policyMap = {
+            {"default", Policy::systemDefault},
+            {"4k", Policy::smallPages},
+            {"thp", Policy::transparentHugePages},
+            {"hugetlb", Policy::hugePages},
+            {"numa_local", Policy::numaLocal},
+            {"numa_interleave", Policy::numaInterleave}
+    };
+
+    constexpr size_t hugePageSize = size_t(2) * 1024 * 1024;
+
+    /**
+     * Every policy but systemDefault maps whole huge pages, so the size to unmap can be worked out again from the
+     * requested size alone
+     */
+    inline size_t mappedSize(size_t bytes) {
+        return (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+    }
+
+#ifdef ALGOGAUGE_LINUX_ALLOCATION
+
+    /**
+     * Reads which NUMA nodes are online (a list like "0-1,3") into a bit mask. Nodes past 63 are left out
+     * @return The mask, or 0 if the system doesn't say
+     */
+    inline unsigned long onlineNodeMask() {
+        std::ifstream nodeFile("/sys/devices/system/node/online");
+        std::string nodes;
+        if (!(nodeFile >> nodes)) return 0;
+        unsigned long mask = 0;
+        size_t position = 0;
+        while (position < nodes.size()) {
+            size_t end = nodes.find(',', position);
+            if (end == std::string::npos) end = nodes.size();
+            const std::string range = nodes.substr(position, end - position);
+            const size_t dash = range.find('-');
+            const unsigned long first = std::stoul(range.substr(0, dash));
+            const unsigned long last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+            for (unsigned long node = first; node <= last && node < 64; node++) mask |= 1ul << node;
+            position = end + 1;
+        }
+        return mask;
+    }
+
+    /**
+     * Sets the NUMA policy of a mapping with the mbind system call, so there is no dependency on libnuma. Pages are
+     * placed when they are first touched, which for the sort buffers is while the values are loaded
+     * @return true if the kernel accepted the policy
+     */
+    inline bool bindToNodes(void *pointer, size_t bytes, Policy policy) {
+        constexpr int preferred = 1; // MPOL_PREFERRED
+        constexpr int interleave = 3; // MPOL_INTERLEAVE
+        unsigned long mask;
+        if (policy == numaLocal) {
+            // the values are filled in parallel, so plain first touch would scatter them over the workers' nodes.
+            // Prefer the node of the thread that will run the sort instead
+            unsigned int cpu = 0, node = 0;
+            if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= 64) return false;
+            mask = 1ul << node;
+        } else {
+            mask = onlineNodeMask();
+            if (mask == 0) return false;
+        }
+        const unsigned long maxNode = sizeof(mask) * 8 + 1; // the kernel reads one bit less than it is given
+        return syscall(SYS_mbind, pointer, bytes, policy == numaLocal ? preferred : interleave, &mask, maxNode, 0) == 0;
+    }
+
+    /**
+     * Maps anonymous memory aligned to a huge page, by mapping one huge page too many and trimming off both ends
+     * @return The mapping, or nullptr if it couldn't be made
+     */
+    inline void *mapAligned(size_t bytes) {
+        void *mapping = mmap(nullptr, bytes + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) return nullptr;
+        const auto address = reinterpret_cast<uintptr_t>(mapping);
+        const uintptr_t aligned = (address + hugePageSize - 1) / hugePageSize * hugePageSize;
+        if (aligned > address) munmap(mapping, aligned - address);
+        munmap(reinterpret_cast<void *>(aligned + bytes), address + hugePageSize - aligned);
+        return reinterpret_cast<void *>(aligned);
+    }
+
+#endif
+
+    /**
+     * Allocates a buffer with the requested policy. When the system can't give the requested policy the buffer is
+     * still allocated, with the closest policy that worked, and used says which one that was
+     * @param bytes The size of the buffer
+     * @param requested The policy to try
+     * @param used Set to the policy the buffer actually got
+     * @return The buffer. Must be given back to release() with the same bytes and requested policy
+     */
+    inline void *allocate(size_t bytes, Policy requested, Policy &used) {
+        if (bytes == 0) bytes = 1;
+#ifdef ALGOGAUGE_LINUX_ALLOCATION
+        if (requested != systemDefault) {
+            const size_t size = mappedSize(bytes);
+            if (requested == hugePages) {
+                int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_2MB
+                flags |= MAP_HUGE_2MB;
+#endif
+                void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+                if (mapping != MAP_FAILED) {
+                    used = hugePages;
+                    return mapping;
+                }
+                // nothing reserved in /proc/sys/vm/nr_hugepages, so let the kernel back it with huge pages if it can
+                requested = transparentHugePages;
+            }
+
+            void *mapping = mapAligned(size);
+            if (mapping == nullptr) throw std::bad_alloc();
+            used = systemDefault;
+            if (requested == transparentHugePages) {
+                if (madvise(mapping, size, MADV_HUGEPAGE) == 0) used = transparentHugePages;
+            } else {
+                // the NUMA policies are measured on 4K pages too, so only the placement differs from smallPages
+                if (madvise(mapping, size, MADV_NOHUGEPAGE) == 0) used = smallPages;
+                if (requested != smallPages && bindToNodes(mapping, size, requested)) used = requested;
+            }
+            return mapping;
+        }
+#endif
+        used = systemDefault;
+        return ::operator new(bytes);
+    }
+
+    /**
+     * Frees a buffer from allocate()
+     * @param pointer The buffer. May be nullptr
+     * @param bytes The size it was allocated with
+     * @param requested The policy it was allocated with
+     */
+    inline void release(void *pointer, size_t bytes, Policy requested) {
+        if (pointer == nullptr) return;
+#ifdef ALGOGAUGE_LINUX_ALLOCATION
+        if (requested != systemDefault) {
+            munmap(pointer, mappedSize(bytes == 0 ? 1 : bytes));
+            return;
+        }
+#endif
+        ::operator delete(pointer);
+    }
+
+} // namespace Allocation
+
+#endif //ALGOGAUGE_ALLOCATION_HPP
@@ -0,0 +1,207 @@
+/**
+ * @brief Keeps the rest of the machine out of the benchmarks. The program can be pinned to chosen CPUs, so the
+ * scheduler can't move a sort between cores half way through and throw away its caches, run at the highest
+ * priority, and keep every page locked in memory. The CPUs' frequency scaling governors are checked as well, as a
+ * core that changes speed during a sort changes its time just as much. Only Linux supports any of it.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_ISOLATION_HPP
+#define ALGOGAUGE_ISOLATION_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#define ALGOGAUGE_LINUX_ISOLATION 1
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace Isolation {
+
+    /**
+     * Reads a CPU list like the kernel writes them ("2", "0,2" or "4-7,12")
+     * @param list The list to read
+     * @return Every CPU in the list, in ascending order without repeats
+     * @throws std::invalid_argument if the list can't be read
+     */
+    inline std::vector<unsigned int> parseCpuList(const std::string &list) {
+        std::set<unsigned int> cpus;
+        size_t position = 0;
+        while (position <= list.size()) {
+            size_t end = list.find(',', position);
+            if (end == std::string::npos) end = list.size();
+            const std::string range = list.substr(position, end - position);
+            const size_t dash = range.find('-');
+            const std::string firstText = range.substr(0, dash);
+            const std::string lastText = dash == std::string::npos ? firstText : range.substr(dash + 1);
+            if (firstText.empty() || lastText.empty()
+                || firstText.find_first_not_of("0123456789") != std::string::npos
+                || lastText.find_first_not_of("0123456789") != std::string::npos) {
+                throw std::invalid_argument("Could not read the CPU list: " + list);
+            }
+            const unsigned long first = std::stoul(firstText);
+            const unsigned long last = std::stoul(lastText);
+            if (first > last || last >= 4096) throw std::invalid_argument("Could not read the CPU list: " + list);
+            for (unsigned long cpu = first; cpu <= last; cpu++) cpus.insert(static_cast<unsigned int>(cpu));
+            position = end + 1;
+        }
+        return {cpus.begin(), cpus.end()};
+    }
+
+    /**
+     * Writes CPUs back out as a list, with consecutive CPUs joined into ranges
+     */
+    inline std::string toCpuList(const std::vector<unsigned int> &cpus) {
+        std::string list;
+        for (size_t i = 0; i < cpus.size(); i++) {
+            size_t last = i;
+            while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) last++;
+            if (!list.empty()) list += ",";
+            list += std::to_string(cpus[i]);
+            if (last > i) list += "-" + std::to_string(cpus[last]);
+            i = last;
+        }
+        return list;
+    }
+
+    /**
+     * @return The frequency scaling governor of a CPU, or "unknown" when the system doesn't have one (as in most
+     * virtual machines)
+     */
+    inline std::string readGovernor(unsigned int cpu) {
+        std::ifstream governorFile("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor");
+        std::string governor;
+        if (!(governorFile >> governor)) return "unknown";
+        return governor;
+    }
+
+    /**
+     * Applies the isolation settings once for the whole program (see global()). Threads inherit the affinity and
+     * priority of the thread that starts them, so every thread pool started afterwards runs on the same CPUs
+     */
+    class Isolator {
+    public:
+        static Isolator &global();
+
+        void apply(const std::vector<unsigned int> &requestedCpus, bool isolate, bool verbose);
+        bool isActive() const { return active; }
+        const std::vector<unsigned int> &getCpus() const { return cpus; }
+        std::string getCpuList() const { return toCpuList(cpus); }
+        bool isPriorityRaised() const { return priorityRaised; }
+        bool isMemoryLocked() const { return memoryLocked; }
+
+        bool pin() const;
+        std::string checkGovernors();
+
+    private:
+        Isolator() = default;
+
+        bool active{false};
+        bool priorityRaised{false};
+        bool memoryLocked{false};
+        std::vector<unsigned int> cpus;
+        std::set<std::string> warnedGovernors; // so each governor is only warned about once
+    };
+
+    inline Isolator &Isolator::global() {
+        static Isolator isolator;
+        return isolator;
+    }
+
+    /**
+     * Pins the calling thread, and with isolate also raises its priority and locks the program's memory. Anything
+     * that the system doesn't allow (most of it needs root) is warned about and skipped, so the benchmarks still run
+     * @param requestedCpus The CPUs to run on. If empty, isolate picks the CPU the program is running on now
+     * @param isolate Whether to also raise the priority and lock memory
+     * @param verbose Whether to print what was done
+     */
+    inline void Isolator::apply(const std::vector<unsigned int> &requestedCpus, bool isolate, bool verbose) {
+        if (requestedCpus.empty() && !isolate) return;
+#ifdef ALGOGAUGE_LINUX_ISOLATION
+        cpus = requestedCpus;
+        if (cpus.empty()) {
+            const int current = sched_getcpu();
+            cpus.push_back(current < 0 ? 0u : static_cast<unsigned int>(current));
+        }
+        active = true;
+        if (!pin()) {
+            std::cerr << "Warning: could not pin to CPUs " << getCpuList() << ", they may be offline or outside this"
+                      << " program's cpuset" << std::endl;
+        } else if (verbose) {
+            std::cout << "Pinned to CPUs " << getCpuList() << std::endl;
+        }
+        if (!isolate) return;
+
+        // a nice value of -20 rather than a real time policy, so a sort that never finishes can't lock up the machine
+        priorityRaised = setpriority(PRIO_PROCESS, 0, -20) == 0;
+        if (!priorityRaised) {
+            std::cerr << "Warning: could not raise the scheduling priority, which needs root or CAP_SYS_NICE" << std::endl;
+        }
+
+        // MCL_FUTURE also locks every later allocation, which fails once the limit is reached. Without root the
+        // limit is usually a few megabytes, so the sort buffers would fail to allocate rather than go unlocked
+        rlimit lockLimit{};
+        const bool unlimited = getrlimit(RLIMIT_MEMLOCK, &lockLimit) == 0 && lockLimit.rlim_cur == RLIM_INFINITY;
+        memoryLocked = (unlimited || geteuid() == 0) && mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+        if (!memoryLocked) {
+            std::cerr << "Warning: could not lock memory, which needs root or an unlimited ulimit -l" << std::endl;
+        }
+        if (verbose) {
+            std::cout << "Priority " << (priorityRaised ? "raised" : "unchanged") << ", memory "
+                      << (memoryLocked ? "locked" : "not locked") << std::endl;
+        }
+#else
+        std::cerr << "Warning: pinning and isolating are only supported on Linux" << std::endl;
+#endif
+    }
+
+    /**
+     * Pins the calling thread to the CPUs again. Called before every sort in case anything changed the affinity
+     * @return true if the thread is pinned
+     */
+    inline bool Isolator::pin() const {
+        if (!active) return false;
+#ifdef ALGOGAUGE_LINUX_ISOLATION
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (unsigned int cpu : cpus) {
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Reads the frequency scaling governor of every pinned CPU, and warns the first time one isn't "performance"
+     * @return The governors, joined by commas when the CPUs differ
+     */
+    inline std::string Isolator::checkGovernors() {
+        std::set<std::string> governors;
+        for (unsigned int cpu : cpus) governors.insert(readGovernor(cpu));
+        std::string joined;
+        for (const std::string &governor : governors) {
+            if (governor != "performance" && governor != "unknown" && warnedGovernors.insert(governor).second) {
+                std::cerr << "Warning: CPUs " << getCpuList() << " use the " << governor << " frequency governor, so"
+                          << " their speed can change during a sort. Use the performance governor for stable times"
+                          << std::endl;
+            }
+            joined += (joined.empty() ? "" : ",") + governor;
+        }
+        return joined;
+    }
+
+} // namespace Isolation
+
+#endif //ALGOGAUGE_ISOLATION_HPP
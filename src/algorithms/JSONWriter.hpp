@@ -0,0 +1,192 @@
+/**
+ * @brief Writes the results as JSON while they are produced, rather than building them into one string first. Text
+ * goes through an OutputBuffer straight to stdout or the --file (or both), and numbers are formatted with
+ * std::to_chars, so memory use stays the same whatever the size of the arrays or the number of results.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_JSONWRITER_HPP
+#define ALGOGAUGE_JSONWRITER_HPP
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "KeyTypes.hpp"
+#include "OutputBuffer.hpp"
+
+namespace Output {
+
+    /**
+     * Writes one JSON document, placing the commas itself. Keys and values are written in order, so an object is
+     * beginObject(), then key() and a value for each member, then endObject()
+     */
+    class JSONWriter {
+    public:
+        /**
+         * @param sinks The files to write to. With none, the JSON is thrown away
+         */
+        explicit JSONWriter(std::vector<std::FILE *> sinks) : output(std::move(sinks)) {}
+
+        JSONWriter &beginObject() { return open('{'); }
+        JSONWriter &endObject() { return close('}'); }
+        JSONWriter &beginArray() { return open('['); }
+        JSONWriter &endArray() { return close(']'); }
+
+        /**
+         * Writes the name of the next member of an object
+         */
+        JSONWriter &key(std::string_view name) {
+            separate();
+            writeString(name);
+            write(": ");
+            afterKey = true;
+            return *this;
+        }
+
+        JSONWriter &value(std::string_view text) {
+            separate();
+            writeString(text);
+            return *this;
+        }
+        JSONWriter &value(const char *text) { return value(std::string_view(text)); }
+        JSONWriter &value(const std::string &text) { return value(std::string_view(text)); }
+
+        JSONWriter &value(bool flag) {
+            separate();
+            write(flag ? "true" : "false");
+            return *this;
+        }
+
+        JSONWriter &value(std::nullptr_t) {
+            separate();
+            write("null");
+            return *this;
+        }
+
+        template<typename Integer, typename std::enable_if<std::is_integral<Integer>::value && !std::is_same<Integer, bool>::value, int>::type = 0>
+        JSONWriter &value(Integer number) {
+            separate();
+            char *position = output.reserve(24);
+            output.commit(std::to_chars(position, position + 24, number).ptr);
+            return *this;
+        }
+
+        /**
+         * Writes a number with 6 decimal places, the same as std::to_string. JSON has no infinity or NaN, so those
+         * are written as null
+         */
+        JSONWriter &value(double number) {
+            if (!std::isfinite(number)) return value(nullptr);
+            separate();
+            // the longest double in fixed notation is 309 digits, a sign, a point and 6 decimals
+            char *position = output.reserve(320);
+            output.commit(std::to_chars(position, position + 320, number, std::chars_format::fixed, 6).ptr);
+            return *this;
+        }
+
+        /**
+         * Writes an element of a sort, the same way KeyTypes::KeyTraits<T>::toString() does
+         */
+        template<typename T>
+        JSONWriter &element(const T &element) {
+            separate();
+            constexpr size_t maxChars = KeyTypes::KeyTraits<T>::maxChars;
+            char *position = output.reserve(maxChars);
+            output.commit(KeyTypes::KeyTraits<T>::toChars(position, position + maxChars, element));
+            return *this;
+        }
+
+        /**
+         * Writes JSON that was already made elsewhere (perf data, hash table results, other languages' results) as
+         * the next value. It may hold several comma separated values when written into an array
+         */
+        JSONWriter &raw(std::string_view json) {
+            separate();
+            write(json);
+            return *this;
+        }
+
+        /**
+         * Closes every array and object that is still open, so the JSON written so far parses. Used when a run fails
+         * part way through
+         */
+        void closeAll() {
+            afterKey = false;
+            while (!closers.empty()) close(closers.back());
+        }
+
+        /**
+         * Hands everything buffered so far to the sinks
+         * @throws std::runtime_error if a sink couldn't be written to
+         */
+        void flush() { output.flush(); }
+
+    private:
+        JSONWriter &open(char bracket) {
+            separate();
+            write(std::string_view(&bracket, 1));
+            hasMembers.push_back(false);
+            closers.push_back(bracket == '{' ? '}' : ']');
+            return *this;
+        }
+
+        JSONWriter &close(char bracket) {
+            write(std::string_view(&bracket, 1));
+            hasMembers.pop_back();
+            closers.pop_back();
+            return *this;
+        }
+
+        /**
+         * Writes the comma before a value, unless it is the first in its array or object or follows its key
+         */
+        void separate() {
+            if (afterKey) {
+                afterKey = false;
+                return;
+            }
+            if (hasMembers.empty()) return;
+            if (hasMembers.back()) write(",");
+            hasMembers.back() = true;
+        }
+
+        void writeString(std::string_view text) {
+            write("\"");
+            size_t start = 0;
+            for (size_t i = 0; i < text.size(); i++) {
+                const unsigned char character = static_cast<unsigned char>(text[i]);
+                if (character != '"' && character != '\\' && character >= 0x20) continue;
+                write(text.substr(start, i - start));
+                char escaped[7];
+                if (character == '"' || character == '\\') {
+                    escaped[0] = '\\';
+                    escaped[1] = char(character);
+                    write(std::string_view(escaped, 2));
+                } else {
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", character);
+                    write(std::string_view(escaped, 6));
+                }
+                start = i + 1;
+            }
+            write(text.substr(start));
+            write("\"");
+        }
+
+        void write(std::string_view text) { output.write(text); }
+
+        OutputBuffer output;
+        std::vector<bool> hasMembers; // for each array or object that is open, whether anything is in it yet
+        std::string closers; // and the bracket that closes it
+        bool afterKey{false};
+    };
+
+} // namespace Output
+
+#endif //ALGOGAUGE_JSONWRITER_HPP
@@ -0,0 +1,367 @@
+/**
+ * @brief The element types the sorting algorithms can be run on. Besides the built in number types there are fixed
+ * size strings and key/payload records, since real sorts usually move records around rather than bare ints. Each
+ * type has a KeyTraits specialization that tells BaseSort how to generate, print and radix sort it. Any of them can be
+ * wrapped in Counted, which counts every comparison, swap, move and allocation the sort makes.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_KEYTYPES_HPP
+#define ALGOGAUGE_KEYTYPES_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace KeyTypes {
+
+    /**
+     * A string of exactly Bytes characters with no null terminator. Compared byte by byte like memcmp
+     * @tparam Bytes The number of characters (and the size of the type)
+     */
+    template<unsigned int Bytes>
+    struct FixedString {
+        char chars[Bytes];
+
+        bool operator<(const FixedString &other) const { return std::memcmp(chars, other.chars, Bytes) < 0; }
+        bool operator>(const FixedString &other) const { return other < *this; }
+        bool operator<=(const FixedString &other) const { return !(other < *this); }
+        bool operator>=(const FixedString &other) const { return !(*this < other); }
+        bool operator==(const FixedString &other) const { return std::memcmp(chars, other.chars, Bytes) == 0; }
+        bool operator!=(const FixedString &other) const { return !(*this == other); }
+    };
+
+    /**
+     * A 64 bit key followed by a payload that pads the record out to Bytes. Only the key is compared, the payload just
+     * gets moved along with it
+     * @tparam Bytes The size of the whole record. Must be at least 16
+     */
+    template<unsigned int Bytes>
+    struct Record {
+        static_assert(Bytes >= 16, "A record must have room for its key and at least 8 bytes of payload");
+
+        uint64_t key;
+        unsigned char payload[Bytes - sizeof(uint64_t)];
+
+        bool operator<(const Record &other) const { return key < other.key; }
+        bool operator>(const Record &other) const { return key > other.key; }
+        bool operator<=(const Record &other) const { return key <= other.key; }
+        bool operator>=(const Record &other) const { return key >= other.key; }
+        bool operator==(const Record &other) const { return key == other.key; }
+        bool operator!=(const Record &other) const { return key != other.key; }
+    };
+
+    /**
+     * Describes how BaseSort works with an element type. Every specialization has:
+     * name - what --key-type calls it
+     * maxNumber - the largest number fromNumber() maps without losing order. Random values are drawn up to this
+     * fromNumber() - turns a number into an element. Bigger numbers never make smaller elements
+     * toString() - the element written as a JSON value
+     * toChars() - toString() without the allocation, written to [first, last), which must hold at least maxChars.
+     * Returns one past the last character written
+     * hasRadixKey/RadixKey/radixKey() - whether the radix sorts can sort it, and the unsigned key they sort on. The key
+     * must order the same way as the element does
+     */
+    template<typename T>
+    struct KeyTraits;
+
+    template<>
+    struct KeyTraits<unsigned int> {
+        static constexpr const char *name = "uint32";
+        static constexpr uint64_t maxNumber = UINT32_MAX;
+        static unsigned int fromNumber(uint64_t number) { return static_cast<unsigned int>(number); }
+        static std::string toString(const unsigned int &value) { return std::to_string(value); }
+        static constexpr size_t maxChars = 10;
+        static char *toChars(char *first, char *last, const unsigned int &value) { return std::to_chars(first, last, value).ptr; }
+
+        static constexpr bool hasRadixKey = true;
+        using RadixKey = unsigned int;
+        static RadixKey radixKey(const unsigned int &value) { return value; }
+    };
+
+    template<>
+    struct KeyTraits<uint64_t> {
+        static constexpr const char *name = "uint64";
+        static constexpr uint64_t maxNumber = UINT64_MAX;
+        static uint64_t fromNumber(uint64_t number) { return number; }
+        static std::string toString(const uint64_t &value) { return std::to_string(value); }
+        static constexpr size_t maxChars = 20;
+        static char *toChars(char *first, char *last, const uint64_t &value) { return std::to_chars(first, last, value).ptr; }
+
+        static constexpr bool hasRadixKey = true;
+        using RadixKey = uint64_t;
+        static RadixKey radixKey(const uint64_t &value) { return value; }
+    };
+
+    template<>
+    struct KeyTraits<float> {
+        static constexpr const char *name = "float";
+        static constexpr uint64_t maxNumber = uint64_t(1) << 24; // every integer up to here is exact in a float
+        static float fromNumber(uint64_t number) { return static_cast<float>(number); }
+        static std::string toString(const float &value) { // formatted by toChars(), so the two always match
+            char chars[maxChars];
+            return std::string(chars, toChars(chars, chars + maxChars, value));
+        }
+        static constexpr size_t maxChars = 16; // 9 significant digits, so every float reads back the same
+        static char *toChars(char *first, char *last, const float &value) {
+            return std::to_chars(first, last, value, std::chars_format::general, 9).ptr;
+        }
+
+        static constexpr bool hasRadixKey = true;
+        using RadixKey = uint32_t;
+        static RadixKey radixKey(const float &value) {
+            // flipping the sign bit of positives and every bit of negatives makes the bits order like the floats do
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+        }
+    };
+
+    template<>
+    struct KeyTraits<double> {
+        static constexpr const char *name = "double";
+        static constexpr uint64_t maxNumber = uint64_t(1) << 53; // every integer up to here is exact in a double
+        static double fromNumber(uint64_t number) { return static_cast<double>(number); }
+        static std::string toString(const double &value) { // formatted by toChars(), so the two always match
+            char chars[maxChars];
+            return std::string(chars, toChars(chars, chars + maxChars, value));
+        }
+        static constexpr size_t maxChars = 24; // 17 significant digits, so every double reads back the same
+        static char *toChars(char *first, char *last, const double &value) {
+            return std::to_chars(first, last, value, std::chars_format::general, 17).ptr;
+        }
+
+        static constexpr bool hasRadixKey = true;
+        using RadixKey = uint64_t;
+        static RadixKey radixKey(const double &value) {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits & 0x8000000000000000ull ? ~bits : bits | 0x8000000000000000ull;
+        }
+    };
+
+    template<>
+    struct KeyTraits<FixedString<16>> {
+        static constexpr const char *name = "string16";
+        static constexpr uint64_t maxNumber = UINT64_MAX;
+
+        /**
+         * Writes the number in base 26 with the letters a to z, most significant letter first and padded with 'a' on
+         * the left. 26^16 is more than 2^64, so every number fits and the strings sort in the same order as the numbers
+         */
+        static FixedString<16> fromNumber(uint64_t number) {
+            FixedString<16> value;
+            for (unsigned int i = 16; i > 0; i--) {
+                value.chars[i - 1] = static_cast<char>('a' + number % 26);
+                number /= 26;
+            }
+            return value;
+        }
+        static std::string toString(const FixedString<16> &value) { return "\"" + std::string(value.chars, 16) + "\""; }
+        static constexpr size_t maxChars = 18;
+        static char *toChars(char *first, char *, const FixedString<16> &value) {
+            *first = '"';
+            std::memcpy(first + 1, value.chars, 16);
+            first[17] = '"';
+            return first + 18;
+        }
+
+        static constexpr bool hasRadixKey = false;
+        using RadixKey = void;
+    };
+
+    /**
+     * Shared by every record size. Records are printed by their key
+     */
+    template<unsigned int Bytes>
+    struct RecordTraits {
+        static constexpr uint64_t maxNumber = UINT64_MAX;
+        static Record<Bytes> fromNumber(uint64_t number) {
+            Record<Bytes> value;
+            value.key = number;
+            std::memset(value.payload, static_cast<unsigned char>(number), sizeof(value.payload));
+            return value;
+        }
+        static std::string toString(const Record<Bytes> &value) { return std::to_string(value.key); }
+        static constexpr size_t maxChars = 20;
+        static char *toChars(char *first, char *last, const Record<Bytes> &value) { return std::to_chars(first, last, value.key).ptr; }
+
+        static constexpr bool hasRadixKey = true;
+        using RadixKey = uint64_t;
+        static RadixKey radixKey(const Record<Bytes> &value) { return value.key; }
+    };
+
+    template<>
+    struct KeyTraits<Record<16>> : RecordTraits<16> {
+        static constexpr const char *name = "record16";
+    };
+
+    template<>
+    struct KeyTraits<Record<64>> : RecordTraits<64> {
+        static constexpr const char *name = "record64";
+    };
+
+    /**
+     * The operations a sort made on its elements
+     */
+    struct OperationCounts {
+        uint64_t comparisons{0};
+        uint64_t swaps{0}; // A swap counts once here, and not as moves
+        uint64_t moves{0}; // Every element copied or assigned
+        uint64_t bytesAllocated{0}; // By new and new[] of the elements
+
+        OperationCounts &operator+=(const OperationCounts &other) {
+            comparisons += other.comparisons;
+            swaps += other.swaps;
+            moves += other.moves;
+            bytesAllocated += other.bytesAllocated;
+            return *this;
+        }
+
+        OperationCounts operator-(const OperationCounts &other) const {
+            return {comparisons - other.comparisons, swaps - other.swaps, moves - other.moves,
+                    bytesAllocated - other.bytesAllocated};
+        }
+    };
+
+    /**
+     * Every thread counts into its own OperationCounts, so the parallel sorts don't fight over one cache line, and
+     * total() adds them all up. Threads that have finished leave their counts behind in retired
+     */
+    class OperationCounter {
+    public:
+        static OperationCounts &local() {
+            static thread_local Registration registration;
+            return registration.counts;
+        }
+
+        /**
+         * @return The counts of every thread so far. Only exact while no other thread is sorting
+         */
+        static OperationCounts total() {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            OperationCounts sum = registry().retired;
+            for (const OperationCounts *counts : registry().threads) sum += *counts;
+            return sum;
+        }
+
+    private:
+        struct Registry {
+            std::mutex mutex;
+            std::vector<const OperationCounts *> threads;
+            OperationCounts retired;
+        };
+
+        struct Registration {
+            OperationCounts counts;
+
+            Registration() {
+                std::lock_guard<std::mutex> lock(registry().mutex);
+                registry().threads.push_back(&counts);
+            }
+
+            ~Registration() {
+                std::lock_guard<std::mutex> lock(registry().mutex);
+                auto &threads = registry().threads;
+                for (size_t i = 0; i < threads.size(); i++) {
+                    if (threads[i] != &counts) continue;
+                    threads.erase(threads.begin() + long(i));
+                    break;
+                }
+                registry().retired += counts;
+            }
+        };
+
+        static Registry &registry() {
+            static Registry instance;
+            return instance;
+        }
+    };
+
+    /**
+     * Wraps an element type and counts what the sort does with it. It is a separate type, so the sorts are compiled a
+     * second time for it and the uncounted elements stay exactly as fast as before. Laid out exactly like T
+     * @tparam T The element type to count
+     */
+    template<typename T>
+    struct Counted {
+        T value;
+
+        Counted() = default;
+        explicit Counted(const T &value) : value(value) {}
+        Counted(const Counted &other) : value(other.value) { OperationCounter::local().moves++; }
+        Counted &operator=(const Counted &other) {
+            value = other.value;
+            OperationCounter::local().moves++;
+            return *this;
+        }
+
+        bool operator<(const Counted &other) const { OperationCounter::local().comparisons++; return value < other.value; }
+        bool operator>(const Counted &other) const { OperationCounter::local().comparisons++; return value > other.value; }
+        bool operator<=(const Counted &other) const { OperationCounter::local().comparisons++; return value <= other.value; }
+        bool operator>=(const Counted &other) const { OperationCounter::local().comparisons++; return value >= other.value; }
+        bool operator==(const Counted &other) const { OperationCounter::local().comparisons++; return value == other.value; }
+        bool operator!=(const Counted &other) const { OperationCounter::local().comparisons++; return value != other.value; }
+
+        static void *operator new(size_t bytes) {
+            OperationCounter::local().bytesAllocated += bytes;
+            return ::operator new(bytes);
+        }
+        static void *operator new[](size_t bytes) {
+            OperationCounter::local().bytesAllocated += bytes;
+            return ::operator new[](bytes);
+        }
+        static void operator delete(void *pointer) { ::operator delete(pointer); }
+        static void operator delete[](void *pointer) { ::operator delete[](pointer); }
+    };
+
+    template<typename T>
+    struct IsCounted : std::false_type {};
+
+    template<typename T>
+    struct IsCounted<Counted<T>> : std::true_type {};
+
+    /**
+     * Swaps two elements. The sorts swap through this rather than std::swap, so Counted can count it as one swap
+     */
+    template<typename T>
+    inline void swapValues(T &a, T &b) {
+        std::swap(a, b);
+    }
+
+    template<typename T>
+    inline void swapValues(Counted<T> &a, Counted<T> &b) {
+        OperationCounter::local().swaps++;
+        std::swap(a.value, b.value);
+    }
+
+    /**
+     * Counted elements generate, print and radix sort like the type they wrap, and go by its name
+     */
+    template<typename T>
+    struct KeyTraits<Counted<T>> {
+        static_assert(sizeof(Counted<T>) == sizeof(T), "Counted values are shared with uncounted sorts through the dataset cache");
+
+        static constexpr const char *name = KeyTraits<T>::name;
+        static constexpr uint64_t maxNumber = KeyTraits<T>::maxNumber;
+        static Counted<T> fromNumber(uint64_t number) { return Counted<T>(KeyTraits<T>::fromNumber(number)); }
+        static std::string toString(const Counted<T> &value) { return KeyTraits<T>::toString(value.value); }
+        static constexpr size_t maxChars = KeyTraits<T>::maxChars;
+        static char *toChars(char *first, char *last, const Counted<T> &value) { return KeyTraits<T>::toChars(first, last, value.value); }
+
+        static constexpr bool hasRadixKey = KeyTraits<T>::hasRadixKey;
+        using RadixKey = typename KeyTraits<T>::RadixKey;
+        static RadixKey radixKey(const Counted<T> &value) { return KeyTraits<T>::radixKey(value.value); }
+    };
+
+} // namespace KeyTypes
+
+#endif //ALGOGAUGE_KEYTYPES_HPP
@@ -0,0 +1,92 @@
+/**
+ * @brief The buffer every results format is written through. It collects small writes into one fixed size buffer
+ * and hands it to stdout, the --file (or both) once it fills, so writing the results takes the same memory however
+ * much there is to write.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_OUTPUTBUFFER_HPP
+#define ALGOGAUGE_OUTPUTBUFFER_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace Output {
+
+    class OutputBuffer {
+    public:
+        static constexpr size_t bufferSize = 1 << 16;
+
+        /**
+         * @param sinks The files to write to. With none, everything is thrown away
+         */
+        explicit OutputBuffer(std::vector<std::FILE *> sinks) : sinks(std::move(sinks)), buffer(new char[bufferSize]) {}
+
+        ~OutputBuffer() = default; // anything not flush()ed is dropped, so a failed run never writes half a document
+        OutputBuffer(const OutputBuffer &) = delete;
+        OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+        /**
+         * @return Where to write the next count characters (at most bufferSize), after moving what's buffered to the
+         * sinks if they wouldn't fit. Call commit() with the end of what was written
+         */
+        char *reserve(size_t count) {
+            if (bufferSize - used < count) writeBuffer();
+            return buffer.get() + used;
+        }
+
+        void commit(const char *end) { used = size_t(end - buffer.get()); }
+
+        void write(std::string_view text) {
+            if (bufferSize - used < text.size()) {
+                writeBuffer();
+                if (text.size() >= bufferSize) { // too big to be worth copying
+                    writeOut(text.data(), text.size());
+                    return;
+                }
+            }
+            std::memcpy(buffer.get() + used, text.data(), text.size());
+            used += text.size();
+        }
+
+        void write(const void *data, size_t size) { write(std::string_view(static_cast<const char *>(data), size)); }
+
+        /**
+         * Hands everything buffered so far to the sinks
+         * @throws std::runtime_error if a sink couldn't be written to, now or by any write before it
+         */
+        void flush() {
+            writeBuffer();
+            for (std::FILE *sink : sinks) failed |= std::fflush(sink) != 0;
+            if (failed) throw std::runtime_error("Could not write the results");
+        }
+
+    private:
+        void writeBuffer() {
+            writeOut(buffer.get(), used);
+            used = 0;
+        }
+
+        /**
+         * A short write is remembered in failed rather than returned, so one partway through a large result can't
+         * be lost by a caller that only checks the final flush()
+         */
+        void writeOut(const char *data, size_t size) {
+            if (size == 0) return;
+            for (std::FILE *sink : sinks) failed |= std::fwrite(data, 1, size, sink) != size;
+        }
+
+        std::vector<std::FILE *> sinks;
+        std::unique_ptr<char[]> buffer;
+        size_t used{0};
+        bool failed{false}; // a write to a sink fell short. Sticky, so flush() reports it however long ago it was
+    };
+
+} // namespace Output
+
+#endif //ALGOGAUGE_OUTPUTBUFFER_HPP
@@ -0,0 +1,803 @@
+/**
+ * @brief A sampling profiler for the sorts. Where PerfEvent counts how many cycles or cache misses a whole sort took,
+ * this samples where they happened: every few thousand events the kernel records the instruction the sort was on and
+ * the call stack that led there. The samples are matched against the symbols of AlgoGauge (and any library it called)
+ * and its line table, so the output shows which functions and source lines the time went to. Needs nothing besides
+ * perf_event_open, so it only works on Linux.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_PROFILER_HPP
+#define ALGOGAUGE_PROFILER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#define ALGOGAUGE_LINUX_PROFILER 1
+#include <cxxabi.h>
+#include <elf.h>
+#include <link.h>
+#include <linux/perf_event.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Profiling {
+
+    /**
+     * Where an address is in the program
+     */
+    struct Location {
+        std::string module; // The file name of the executable or library
+        std::string function; // Demangled, or "[unknown]" when there is no symbol for it
+        std::string file; // Empty when the module has no line table (it wasn't built with -g)
+        unsigned int line{0};
+    };
+
+    /**
+     * Escapes a string to go between quotes in the JSON output
+     */
+    inline std::string escapeJSON(const std::string &text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+#ifdef ALGOGAUGE_LINUX_PROFILER
+
+    /**
+     * The function symbols and line table of one ELF file. Only 64 bit files are read, and the line table only from an
+     * uncompressed .debug_line section. Addresses are the ones the file was linked at, before the loader moved it
+     */
+    class ElfImage {
+    public:
+        explicit ElfImage(const std::string &path);
+
+        const std::string &getFunction(uint64_t address) const;
+        bool getLine(uint64_t address, std::string &file, unsigned int &line) const;
+        bool hasLines() const { return !lines.empty(); }
+
+    private:
+        struct Symbol {
+            uint64_t start;
+            uint64_t size;
+            std::string name;
+        };
+        struct LineRange {
+            uint64_t start;
+            uint64_t end;
+            unsigned int file; // index into files
+            unsigned int line;
+        };
+
+        void readSymbols(const Elf64_Shdr &symbolTable, const Elf64_Shdr &stringTable);
+        void readLines(const std::string &lineSection, const std::string &lineStrings, const std::string &strings);
+        size_t readLineUnit(const std::string &section, size_t offset, const std::string &lineStrings, const std::string &strings);
+
+        std::vector<Symbol> symbols; // sorted by start
+        std::vector<LineRange> lines; // sorted by start
+        std::vector<std::string> files;
+        std::string contents;
+    };
+
+    namespace detail {
+        inline uint64_t readULEB(std::string_view data, size_t &offset) {
+            uint64_t value = 0;
+            unsigned int shift = 0;
+            while (offset < data.size()) {
+                const auto byte = static_cast<uint8_t>(data[offset++]);
+                if (shift < 64) value |= uint64_t(byte & 0x7f) << shift;
+                shift += 7;
+                if (!(byte & 0x80)) break;
+            }
+            return value;
+        }
+
+        inline int64_t readSLEB(std::string_view data, size_t &offset) {
+            int64_t value = 0;
+            unsigned int shift = 0;
+            uint8_t byte = 0;
+            while (offset < data.size()) {
+                byte = static_cast<uint8_t>(data[offset++]);
+                if (shift < 64) value |= int64_t(byte & 0x7f) << shift;
+                shift += 7;
+                if (!(byte & 0x80)) break;
+            }
+            if (shift < 64 && (byte & 0x40)) value |= -(int64_t(1) << shift);
+            return value;
+        }
+
+        inline uint64_t readFixed(std::string_view data, size_t &offset, unsigned int bytes) {
+            uint64_t value = 0;
+            if (offset + bytes > data.size()) {
+                offset = data.size();
+                return 0;
+            }
+            std::memcpy(&value, data.data() + offset, std::min(bytes, 8u)); // ELF files read here are little endian
+            offset += bytes;
+            return value;
+        }
+
+        inline std::string readString(std::string_view data, size_t &offset) {
+            const size_t end = data.find('\0', offset);
+            if (end == std::string_view::npos) {
+                offset = data.size();
+                return "";
+            }
+            std::string text(data.substr(offset, end - offset));
+            offset = end + 1;
+            return text;
+        }
+
+        inline std::string stringAt(std::string_view table, uint64_t offset) {
+            if (offset >= table.size()) return "";
+            size_t position = size_t(offset);
+            return readString(table, position);
+        }
+
+        inline std::string baseName(const std::string &path) {
+            const size_t slash = path.rfind('/');
+            return slash == std::string::npos ? path : path.substr(slash + 1);
+        }
+    } // namespace detail
+
+    inline ElfImage::ElfImage(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return;
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (contents.size() < sizeof(Elf64_Ehdr) || std::memcmp(contents.data(), ELFMAG, SELFMAG) != 0
+            || contents[EI_CLASS] != ELFCLASS64) {
+            contents.clear();
+            return;
+        }
+        Elf64_Ehdr header;
+        std::memcpy(&header, contents.data(), sizeof(header));
+        if (header.e_shoff == 0 || header.e_shoff + uint64_t(header.e_shnum) * sizeof(Elf64_Shdr) > contents.size()
+            || header.e_shstrndx >= header.e_shnum) {
+            contents.clear();
+            return;
+        }
+        std::vector<Elf64_Shdr> sections(header.e_shnum);
+        std::memcpy(sections.data(), contents.data() + header.e_shoff, sections.size() * sizeof(Elf64_Shdr));
+
+        auto sectionData = [this](const Elf64_Shdr &section) {
+            if (section.sh_type == SHT_NOBITS || section.sh_offset + section.sh_size > contents.size()) return std::string();
+            return contents.substr(section.sh_offset, section.sh_size);
+        };
+        const std::string sectionNames = sectionData(sections[header.e_shstrndx]);
+
+        // .symtab has every function, .dynsym only the exported ones, so it's only used when the file was stripped
+        const Elf64_Shdr *symbolTable = nullptr;
+        for (const auto &section : sections) {
+            if (section.sh_type == SHT_SYMTAB || (section.sh_type == SHT_DYNSYM && symbolTable == nullptr))
+                symbolTable = &section;
+        }
+        if (symbolTable != nullptr && symbolTable->sh_link < sections.size())
+            readSymbols(*symbolTable, sections[symbolTable->sh_link]);
+
+        std::string lineSection, lineStrings, strings;
+        for (const auto &section : sections) {
+            if (section.sh_flags & SHF_COMPRESSED) continue;
+            const std::string name = detail::stringAt(sectionNames, section.sh_name);
+            if (name == ".debug_line") lineSection = sectionData(section);
+            else if (name == ".debug_line_str") lineStrings = sectionData(section);
+            else if (name == ".debug_str") strings = sectionData(section);
+        }
+        if (!lineSection.empty()) readLines(lineSection, lineStrings, strings);
+        contents.clear(); // everything needed has been copied out
+        contents.shrink_to_fit();
+    }
+
+    inline void ElfImage::readSymbols(const Elf64_Shdr &symbolTable, const Elf64_Shdr &stringTable) {
+        if (symbolTable.sh_offset + symbolTable.sh_size > contents.size()
+            || stringTable.sh_offset + stringTable.sh_size > contents.size()) return;
+        const size_t count = symbolTable.sh_size / sizeof(Elf64_Sym);
+        for (size_t i = 0; i < count; i++) {
+            Elf64_Sym symbol;
+            std::memcpy(&symbol, contents.data() + symbolTable.sh_offset + i * sizeof(Elf64_Sym), sizeof(symbol));
+            const unsigned char type = ELF64_ST_TYPE(symbol.st_info);
+            if ((type != STT_FUNC && type != STT_GNU_IFUNC) || symbol.st_shndx == SHN_UNDEF || symbol.st_value == 0)
+                continue;
+            if (symbol.st_name >= stringTable.sh_size) continue;
+            symbols.push_back({symbol.st_value, symbol.st_size,
+                               std::string(contents.data() + stringTable.sh_offset + symbol.st_name)});
+        }
+        // aliases share a start address. The one with a size is kept
+        std::sort(symbols.begin(), symbols.end(), [](const Symbol &a, const Symbol &b) {
+            return a.start != b.start ? a.start < b.start : a.size > b.size;
+        });
+        symbols.erase(std::unique(symbols.begin(), symbols.end(), [](const Symbol &a, const Symbol &b) {
+            return a.start == b.start;
+        }), symbols.end());
+    }
+
+    /**
+     * Runs the line number programs of every unit in .debug_line (DWARF 2 to 5), turning each pair of rows into the
+     * address range one source line compiled to
+     */
+    inline void ElfImage::readLines(const std::string &lineSection, const std::string &lineStrings, const std::string &strings) {
+        size_t offset = 0;
+        while (offset < lineSection.size()) {
+            const size_t next = readLineUnit(lineSection, offset, lineStrings, strings);
+            if (next <= offset) break;
+            offset = next;
+        }
+        std::sort(lines.begin(), lines.end(), [](const LineRange &a, const LineRange &b) { return a.start < b.start; });
+    }
+
+    /**
+     * @return The offset of the next unit, or 0 if this one couldn't be read
+     */
+    inline size_t ElfImage::readLineUnit(const std::string &section, size_t offset, const std::string &lineStrings, const std::string &strings) {
+        using namespace detail;
+        unsigned int offsetSize = 4;
+        uint64_t unitLength = readFixed(section, offset, 4);
+        if (unitLength == 0xffffffff) {
+            offsetSize = 8;
+            unitLength = readFixed(section, offset, 8);
+        }
+        const size_t unitEnd = offset + size_t(unitLength);
+        if (unitLength == 0 || unitEnd > section.size()) return 0;
+        const std::string_view unit(section.data(), unitEnd); // so nothing past the unit is read
+
+        const auto version = static_cast<uint16_t>(readFixed(unit, offset, 2));
+        if (version < 2 || version > 5) return unitEnd;
+        unsigned int addressSize = 8;
+        if (version >= 5) {
+            addressSize = unsigned(readFixed(unit, offset, 1));
+            readFixed(unit, offset, 1); // segment selector size
+        }
+        const uint64_t headerLength = readFixed(unit, offset, offsetSize);
+        const size_t programStart = offset + size_t(headerLength);
+        const auto minimumInstructionLength = unsigned(readFixed(unit, offset, 1));
+        if (version >= 4) readFixed(unit, offset, 1); // maximum operations per instruction, only above 1 for VLIW
+        const bool defaultIsStatement = readFixed(unit, offset, 1) != 0;
+        const auto lineBase = static_cast<int8_t>(readFixed(unit, offset, 1));
+        const auto lineRange = unsigned(readFixed(unit, offset, 1));
+        const auto opcodeBase = unsigned(readFixed(unit, offset, 1));
+        if (lineRange == 0 || opcodeBase == 0) return unitEnd;
+        std::vector<unsigned int> opcodeLengths(opcodeBase, 0);
+        for (unsigned int i = 1; i < opcodeBase; i++) opcodeLengths[i] = unsigned(readFixed(unit, offset, 1));
+
+        // the unit's file table, as indexes into files. DWARF 5 numbers files from 0, earlier versions from 1
+        std::vector<unsigned int> unitFiles;
+        auto addFile = [this, &unitFiles](const std::string &path) {
+            files.push_back(baseName(path));
+            unitFiles.push_back(unsigned(files.size() - 1));
+        };
+        if (version < 5) {
+            unitFiles.push_back(0); // placeholder for index 0
+            files.emplace_back("");
+            while (offset < unit.size() && unit[offset] != '\0') readString(unit, offset); // include directories
+            offset++;
+            while (offset < unit.size() && unit[offset] != '\0') {
+                addFile(readString(unit, offset));
+                readULEB(unit, offset); // directory
+                readULEB(unit, offset); // modification time
+                readULEB(unit, offset); // length
+            }
+        } else {
+            // every entry is described by (content type, form) pairs. Only the path is kept
+            auto readEntries = [&](bool keepPaths) {
+                const auto formatCount = unsigned(readFixed(unit, offset, 1));
+                std::vector<std::pair<uint64_t, uint64_t>> formats;
+                for (unsigned int i = 0; i < formatCount; i++) {
+                    const uint64_t contentType = readULEB(unit, offset);
+                    formats.emplace_back(contentType, readULEB(unit, offset));
+                }
+                const uint64_t count = readULEB(unit, offset);
+                for (uint64_t entry = 0; entry < count && offset < unit.size(); entry++) {
+                    std::string path;
+                    for (const auto &format : formats) {
+                        std::string text;
+                        switch (format.second) {
+                            case 0x08: text = readString(unit, offset); break; // DW_FORM_string
+                            case 0x1f: text = stringAt(lineStrings, readFixed(unit, offset, offsetSize)); break; // DW_FORM_line_strp
+                            case 0x0e: text = stringAt(strings, readFixed(unit, offset, offsetSize)); break; // DW_FORM_strp
+                            case 0x0b: readFixed(unit, offset, 1); break; // DW_FORM_data1
+                            case 0x05: readFixed(unit, offset, 2); break; // DW_FORM_data2
+                            case 0x06: readFixed(unit, offset, 4); break; // DW_FORM_data4
+                            case 0x07: readFixed(unit, offset, 8); break; // DW_FORM_data8
+                            case 0x1e: offset += 16; break; // DW_FORM_data16, the MD5
+                            case 0x0f: readULEB(unit, offset); break; // DW_FORM_udata
+                            case 0x09: offset += size_t(readULEB(unit, offset)); break; // DW_FORM_block
+                            default: return false; // a form this doesn't know the size of
+                        }
+                        if (format.first == 1) path = text; // DW_LNCT_path
+                    }
+                    if (keepPaths) addFile(path);
+                }
+                return offset <= unit.size();
+            };
+            if (!readEntries(false) || !readEntries(true)) return unitEnd; // directories, then files
+        }
+
+        // the line number state machine
+        offset = programStart;
+        uint64_t address = 0;
+        uint64_t file = 1;
+        unsigned int line = 1;
+        bool haveRow = false;
+        uint64_t rowAddress = 0;
+        uint64_t rowFile = 0;
+        unsigned int rowLine = 0;
+        auto emitRow = [&](bool endSequence) {
+            if (haveRow && address > rowAddress && rowFile < unitFiles.size())
+                lines.push_back({rowAddress, address, unitFiles[rowFile], rowLine});
+            haveRow = !endSequence;
+            rowAddress = address;
+            rowFile = file;
+            rowLine = line;
+        };
+        auto resetState = [&]() {
+            address = 0;
+            file = 1;
+            line = 1;
+            haveRow = false;
+        };
+        (void) defaultIsStatement;
+        while (offset < unit.size()) {
+            const auto opcode = unsigned(static_cast<uint8_t>(unit[offset++]));
+            if (opcode >= opcodeBase) {
+                const unsigned int adjusted = opcode - opcodeBase;
+                address += (adjusted / lineRange) * minimumInstructionLength;
+                line = unsigned(int(line) + lineBase + int(adjusted % lineRange));
+                emitRow(false);
+                continue;
+            }
+            switch (opcode) {
+                case 0: { // extended opcodes
+                    const uint64_t length = readULEB(unit, offset);
+                    const size_t end = offset + size_t(length);
+                    if (length == 0 || end > unit.size()) return unitEnd;
+                    const auto extended = unsigned(static_cast<uint8_t>(unit[offset++]));
+                    if (extended == 1) { // DW_LNE_end_sequence
+                        emitRow(true);
+                        resetState();
+                    } else if (extended == 2) { // DW_LNE_set_address
+                        address = readFixed(unit, offset, std::min(unsigned(length - 1), addressSize));
+                    }
+                    offset = end;
+                    break;
+                }
+                case 1: emitRow(false); break; // DW_LNS_copy
+                case 2: address += readULEB(unit, offset) * minimumInstructionLength; break; // DW_LNS_advance_pc
+                case 3: line = unsigned(int64_t(line) + readSLEB(unit, offset)); break; // DW_LNS_advance_line
+                case 4: file = readULEB(unit, offset); break; // DW_LNS_set_file
+                case 8: address += ((255 - opcodeBase) / lineRange) * minimumInstructionLength; break; // DW_LNS_const_add_pc
+                case 9: address += readFixed(unit, offset, 2); break; // DW_LNS_fixed_advance_pc
+                default: // the rest only change state that isn't kept, so their operands are skipped
+                    for (unsigned int i = 0; i < opcodeLengths[opcode]; i++) readULEB(unit, offset);
+                    break;
+            }
+        }
+        return unitEnd;
+    }
+
+    inline const std::string &ElfImage::getFunction(uint64_t address) const {
+        static const std::string unknown = "[unknown]";
+        auto it = std::upper_bound(symbols.begin(), symbols.end(), address,
+                                   [](uint64_t a, const Symbol &symbol) { return a < symbol.start; });
+        if (it == symbols.begin()) return unknown;
+        --it;
+        if (it->size != 0 && address >= it->start + it->size) return unknown;
+        return it->name;
+    }
+
+    inline bool ElfImage::getLine(uint64_t address, std::string &file, unsigned int &line) const {
+        auto it = std::upper_bound(lines.begin(), lines.end(), address,
+                                   [](uint64_t a, const LineRange &range) { return a < range.start; });
+        if (it == lines.begin()) return false;
+        --it;
+        if (address >= it->end) return false;
+        file = files[it->file];
+        line = it->line;
+        return true;
+    }
+
+    /**
+     * Turns addresses in this process into functions and source lines. The symbols of a module are only read the
+     * first time one of its addresses is looked up, and every address is only looked up once
+     */
+    class Symbolizer {
+    public:
+        static Symbolizer &global();
+        const Location &locate(uint64_t address);
+
+    private:
+        struct Module {
+            std::string path;
+            std::string name;
+            uint64_t start;
+            uint64_t end;
+            uint64_t bias; // where the loader put the module, less where it was linked
+        };
+
+        Symbolizer() = default;
+        void findModules();
+        static std::string demangle(const std::string &name);
+
+        std::vector<Module> modules;
+        std::map<std::string, std::unique_ptr<ElfImage>> images;
+        std::unordered_map<uint64_t, Location> located;
+        bool modulesFound{false};
+    };
+
+    inline Symbolizer &Symbolizer::global() {
+        static Symbolizer symbolizer;
+        return symbolizer;
+    }
+
+    inline void Symbolizer::findModules() {
+        modulesFound = true;
+        dl_iterate_phdr([](dl_phdr_info *info, size_t, void *data) {
+            auto &found = *static_cast<std::vector<Module> *>(data);
+            // the main program has no name here, but the kernel links to its file
+            const std::string path = info->dlpi_name && info->dlpi_name[0] ? info->dlpi_name : "/proc/self/exe";
+            std::string name = path;
+            if (name == "/proc/self/exe") {
+                char target[4096];
+                const ssize_t length = readlink("/proc/self/exe", target, sizeof(target) - 1);
+                if (length > 0) name.assign(target, size_t(length));
+            }
+            for (int i = 0; i < info->dlpi_phnum; i++) {
+                const auto &segment = info->dlpi_phdr[i];
+                if (segment.p_type != PT_LOAD || !(segment.p_flags & PF_X)) continue;
+                const uint64_t start = info->dlpi_addr + segment.p_vaddr;
+                found.push_back({path, detail::baseName(name), start, start + segment.p_memsz, info->dlpi_addr});
+            }
+            return 0;
+        }, &modules);
+    }
+
+    inline std::string Symbolizer::demangle(const std::string &name) {
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+        if (status != 0 || demangled == nullptr) return name;
+        std::string result(demangled);
+        std::free(demangled);
+        return result;
+    }
+
+    /**
+     * @param address An address in this process
+     * @return The module, function, and (when the module has a line table) source line it belongs to
+     */
+    inline const Location &Symbolizer::locate(uint64_t address) {
+        auto cached = located.find(address);
+        if (cached != located.end()) return cached->second;
+        if (!modulesFound) findModules();
+
+        Location location{"[unknown]", "[unknown]", "", 0};
+        for (const auto &module : modules) {
+            if (address < module.start || address >= module.end) continue;
+            auto &image = images[module.path];
+            if (!image) image.reset(new ElfImage(module.path));
+            const uint64_t linked = address - module.bias;
+            location.module = module.name;
+            location.function = demangle(image->getFunction(linked));
+            image->getLine(linked, location.file, location.line);
+            break;
+        }
+        return located.emplace(address, location).first->second;
+    }
+
+#endif
+
+    /**
+     * Whether the C++ sorts are profiled, and how often they are sampled. Set once for the whole program
+     */
+    struct Settings {
+        bool enabled{false};
+        unsigned int frequency{4000};
+    };
+
+    inline Settings &settings() {
+        static Settings current;
+        return current;
+    }
+
+    /**
+     * One sample: the event count it stands for, then the sampled address, then the return address of every caller
+     * that could be unwound
+     */
+    struct Sample {
+        uint64_t weight;
+        std::vector<uint64_t> stack;
+    };
+
+    /**
+     * Samples the calling thread while it is between start() and stop(), on as many of cycles and cache misses as
+     * the machine can count. Without a PMU (as in most virtual machines) cycles fall back to the cpu-clock timer and
+     * cache misses are left out. The kernel writes samples into a ring buffer per event, which a background thread
+     * empties whenever it is a quarter full, so long sorts don't lose any
+     */
+    class Sampler {
+    public:
+        explicit Sampler(unsigned int frequency);
+        ~Sampler();
+        Sampler(const Sampler &) = delete;
+        Sampler &operator=(const Sampler &) = delete;
+
+        void start();
+        void stop();
+        bool isOpen() const { return !events.empty(); }
+        std::string getJSONString(unsigned int top = 20);
+
+    private:
+        struct Event {
+            std::string name;
+            int fd{-1};
+            char *buffer{nullptr};
+            std::vector<Sample> samples;
+            uint64_t lost{0};
+        };
+
+        bool open(const std::string &name, uint32_t type, uint64_t config);
+        void drain(Event &event);
+        void drainLoop();
+
+        unsigned int frequency;
+        std::vector<Event> events;
+        size_t pageSize{4096};
+        size_t dataSize{0};
+        std::thread drainer;
+        std::atomic<bool> running{false};
+    };
+
+#ifdef ALGOGAUGE_LINUX_PROFILER
+
+    /**
+     * Opens the events. Nothing is sampled until start()
+     * @param frequency Samples per second of each event. The kernel adjusts the period between samples to keep to it
+     */
+    inline Sampler::Sampler(unsigned int frequency) : frequency(frequency) {
+        static bool warned = false; // so the warnings aren't repeated for every sort
+        // the kernel refuses events that ask for more samples than it allows
+        std::ifstream limitFile("/proc/sys/kernel/perf_event_max_sample_rate");
+        unsigned int limit = 0;
+        if (limitFile >> limit && limit > 0 && this->frequency > limit) {
+            if (!warned) std::cerr << "Warning: the kernel allows at most " << limit << " samples per second, so that is used" << std::endl;
+            this->frequency = limit;
+        }
+        pageSize = size_t(sysconf(_SC_PAGESIZE));
+        dataSize = pageSize * 64; // the kernel wants a power of two number of pages
+        if (!open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES)
+            && !open("cpu-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK)) {
+            if (!warned) std::cerr << "Warning: could not open any sampling event, so nothing will be profiled. See docs/PERF.md" << std::endl;
+            warned = true;
+            return;
+        }
+        if (!open("cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES) && !warned)
+            std::cerr << "Warning: cache misses can't be sampled on this machine, so only " << events.front().name << " is profiled" << std::endl;
+        warned = true;
+    }
+
+    inline Sampler::~Sampler() {
+        if (running) stop();
+        for (auto &event : events) {
+            if (event.buffer != nullptr) munmap(event.buffer, pageSize + dataSize);
+            close(event.fd);
+        }
+    }
+
+    inline bool Sampler::open(const std::string &name, uint32_t type, uint64_t config) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = type;
+        attributes.size = sizeof(attributes);
+        attributes.config = config;
+        attributes.freq = 1;
+        attributes.sample_freq = frequency;
+        attributes.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_PERIOD | PERF_SAMPLE_CALLCHAIN;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1; // the sorts run in user space. Sampling the kernel also needs root
+        attributes.exclude_hv = 1;
+        attributes.exclude_callchain_kernel = 1;
+        attributes.watermark = 1;
+        attributes.wakeup_watermark = uint32_t(dataSize / 4);
+
+        const int fd = static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+        if (fd < 0) return false;
+        void *buffer = mmap(nullptr, pageSize + dataSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (buffer == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        Event event;
+        event.name = name;
+        event.fd = fd;
+        event.buffer = static_cast<char *>(buffer);
+        events.push_back(std::move(event));
+        return true;
+    }
+
+    inline void Sampler::start() {
+        if (events.empty() || running) return;
+        running = true;
+        drainer = std::thread(&Sampler::drainLoop, this);
+        for (auto &event : events) ioctl(event.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    inline void Sampler::stop() {
+        if (!running) return;
+        for (auto &event : events) ioctl(event.fd, PERF_EVENT_IOC_DISABLE, 0);
+        running = false;
+        drainer.join();
+        for (auto &event : events) drain(event);
+    }
+
+    inline void Sampler::drainLoop() {
+        std::vector<pollfd> descriptors;
+        for (const auto &event : events) descriptors.push_back({event.fd, POLLIN, 0});
+        while (running) {
+            poll(descriptors.data(), descriptors.size(), 10);
+            for (auto &event : events) drain(event);
+        }
+    }
+
+    /**
+     * Reads every record the kernel has written to an event's ring buffer since the last drain
+     */
+    inline void Sampler::drain(Event &event) {
+        auto *metadata = reinterpret_cast<perf_event_mmap_page *>(event.buffer);
+        const char *data = event.buffer + pageSize;
+        const uint64_t head = __atomic_load_n(&metadata->data_head, __ATOMIC_ACQUIRE);
+        uint64_t tail = metadata->data_tail;
+        std::vector<char> record;
+        while (tail < head) {
+            perf_event_header header;
+            for (size_t i = 0; i < sizeof(header); i++) reinterpret_cast<char *>(&header)[i] = data[(tail + i) % dataSize];
+            if (header.size < sizeof(header)) break;
+            record.resize(header.size);
+            for (size_t i = 0; i < header.size; i++) record[i] = data[(tail + i) % dataSize]; // may wrap around
+            tail += header.size;
+
+            const auto *fields = reinterpret_cast<const uint64_t *>(record.data() + sizeof(header));
+            const size_t fieldCount = (header.size - sizeof(header)) / sizeof(uint64_t);
+            if (header.type == PERF_RECORD_LOST && fieldCount >= 2) {
+                event.lost += fields[1];
+            } else if (header.type == PERF_RECORD_SAMPLE && fieldCount >= 3) {
+                // ip, period, then the number of callchain entries and the entries
+                Sample sample{fields[1], {fields[0]}};
+                const uint64_t depth = std::min<uint64_t>(fields[2], fieldCount - 3);
+                bool first = true;
+                for (uint64_t i = 0; i < depth; i++) {
+                    const uint64_t address = fields[3 + i];
+                    if (address >= uint64_t(PERF_CONTEXT_MAX)) continue; // markers like PERF_CONTEXT_USER
+                    if (first && address == fields[0]) {
+                        first = false;
+                        continue; // the sampled address again
+                    }
+                    first = false;
+                    sample.stack.push_back(address - 1); // inside the call instruction, rather than after it
+                }
+                event.samples.push_back(std::move(sample));
+            }
+        }
+        __atomic_store_n(&metadata->data_tail, tail, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * Attributes the samples to functions and source lines. A function's self share is the part of an event that
+     * happened in its own code. Its total share also counts the functions it called, as long as the stack could be
+     * unwound past them (which needs frame pointers)
+     * @param top How many functions and lines to include, most sampled first
+     * @return The hotspot tables as a JSON object
+     */
+    inline std::string Sampler::getJSONString(unsigned int top) {
+        if (events.empty()) return "{}";
+        Symbolizer &symbolizer = Symbolizer::global();
+
+        struct Share {
+            std::vector<double> self;
+            std::vector<double> total;
+        };
+        std::map<std::pair<std::string, std::string>, Share> functions; // (module, function)
+        std::map<std::tuple<std::string, unsigned int, std::string>, std::vector<double>> lines; // (file, line, function)
+        std::vector<double> totals(events.size(), 0);
+
+        for (size_t e = 0; e < events.size(); e++) {
+            for (const Sample &sample : events[e].samples) {
+                const double weight = double(sample.weight);
+                totals[e] += weight;
+                std::set<std::pair<std::string, std::string>> seen; // recursion only counts once
+                for (size_t frame = 0; frame < sample.stack.size(); frame++) {
+                    const Location &location = symbolizer.locate(sample.stack[frame]);
+                    auto key = std::make_pair(location.module, location.function);
+                    Share &share = functions[key];
+                    share.self.resize(events.size(), 0);
+                    share.total.resize(events.size(), 0);
+                    if (frame == 0) {
+                        share.self[e] += weight;
+                        if (!location.file.empty()) {
+                            auto &line = lines[std::make_tuple(location.file, location.line, location.function)];
+                            line.resize(events.size(), 0);
+                            line[e] += weight;
+                        }
+                    }
+                    if (seen.insert(key).second) share.total[e] += weight;
+                }
+            }
+        }
+
+        auto percent = [&totals](const std::vector<double> &weights, size_t e) {
+            return std::to_string(totals[e] > 0 ? weights[e] / totals[e] * 100 : 0);
+        };
+
+        std::string output = "{";
+        output += R"("frequency": )" + std::to_string(frequency) + ",";
+        output += R"("events": [)";
+        for (size_t e = 0; e < events.size(); e++) {
+            output += R"({"event": ")" + events[e].name + R"(", "samples": )" + std::to_string(events[e].samples.size())
+                      + R"(, "lost": )" + std::to_string(events[e].lost) + "},";
+        }
+        output.back() = ']';
+
+        // ranked by the first event, which is always cycles (or cpu-clock)
+        std::vector<std::pair<std::pair<std::string, std::string>, Share>> rankedFunctions(functions.begin(), functions.end());
+        std::sort(rankedFunctions.begin(), rankedFunctions.end(), [](const auto &a, const auto &b) {
+            return a.second.self[0] != b.second.self[0] ? a.second.self[0] > b.second.self[0] : a.second.total[0] > b.second.total[0];
+        });
+        if (rankedFunctions.size() > top) rankedFunctions.resize(top);
+        output += R"(, "functions": [)";
+        for (const auto &function : rankedFunctions) {
+            output += R"({"function": ")" + escapeJSON(function.first.second) + R"(", "module": ")"
+                      + escapeJSON(function.first.first) + "\"";
+            for (size_t e = 0; e < events.size(); e++) {
+                output += R"(, ")" + events[e].name + R"(": {"self": )" + percent(function.second.self, e)
+                          + R"(, "total": )" + percent(function.second.total, e) + "}";
+            }
+            output += "},";
+        }
+        if (!rankedFunctions.empty()) output.pop_back();
+
+        std::vector<std::pair<std::tuple<std::string, unsigned int, std::string>, std::vector<double>>> rankedLines(lines.begin(), lines.end());
+        std::sort(rankedLines.begin(), rankedLines.end(), [](const auto &a, const auto &b) { return a.second[0] > b.second[0]; });
+        if (rankedLines.size() > top) rankedLines.resize(top);
+        output += R"(], "lines": [)";
+        for (const auto &line : rankedLines) {
+            output += R"({"file": ")" + escapeJSON(std::get<0>(line.first)) + R"(", "line": )"
+                      + std::to_string(std::get<1>(line.first)) + R"(, "function": ")"
+                      + escapeJSON(std::get<2>(line.first)) + "\"";
+            for (size_t e = 0; e < events.size(); e++) output += R"(, ")" + events[e].name + R"(": )" + percent(line.second, e);
+            output += "},";
+        }
+        if (!rankedLines.empty()) output.pop_back();
+        return output + "]}";
+    }
+
+#else
+
+    inline Sampler::Sampler(unsigned int frequency) : frequency(frequency) {}
+    inline Sampler::~Sampler() = default;
+    inline void Sampler::start() {}
+    inline void Sampler::stop() {}
+    inline std::string Sampler::getJSONString(unsigned int) { return "{}"; }
+
+#endif
+
+} // namespace Profiling
+
+#endif //ALGOGAUGE_PROFILER_HPP
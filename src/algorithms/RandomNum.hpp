@@ -1,6 +1,7 @@
 /**
- * @brief Logic for generating random numbers via the Mersenne Twister Engine or by typical standard, seeded random
- * number generator in order to produce a random bool
+ * @brief Logic for generating random numbers. A few small, fast 64 bit generators (Philox, xoshiro256**, PCG64 and
+ * splitmix64) are available next to the Mersenne Twister, and every generator is started from a single 64 bit seed,
+ * so the same seed always reproduces the same values
  * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
  * @copyright Weber State University
  */
@@ -10,25 +11,188 @@
 #define ALGOGAUGE_RANDOMNUM_HPP
 
 #include <iostream>
+#include <cstdint>
 #include <random>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Used for picking which generator RandomNum uses
+ */
+enum RandomGenerator {
+    philox = 0,
+    xoshiro256,
+    pcg64,
+    splitmix64,
+    mersenneTwister
+};
+
+/**
+ * @brief This is used to map to the RandomGenerator enum
+ */
+static const std::string RandomGeneratorStrings[] = {
+        "philox4x32-10",
+        "xoshiro256**",
+        "pcg64",
+        "splitmix64",
+        "mt19937_64"
+};
+
+const std::unordered_map<std::string, RandomGenerator> randomGeneratorMap = {
+        {"philox", RandomGenerator::philox},
+        {"xoshiro256", RandomGenerator::xoshiro256},
+        {"pcg64", RandomGenerator::pcg64},
+        {"splitmix64", RandomGenerator::splitmix64},
+        {"mt19937", RandomGenerator::mersenneTwister}
+};
+
+/**
+ * Sebastiano Vigna's splitmix64. One add and a mix per value. Also used to expand a seed into the state of the other
+ * generators
+ */
+class SplitMix64 {
+public:
+    explicit SplitMix64(uint64_t seed = 0) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t state;
+};
+
+/**
+ * Blackman and Vigna's xoshiro256**. 256 bits of state and a handful of shifts, rotates and xors per value
+ */
+class Xoshiro256StarStar {
+public:
+    explicit Xoshiro256StarStar(uint64_t seed = 0) {
+        SplitMix64 seeder(seed);
+        for (auto &word : state) word = seeder();
+    }
+
+    uint64_t operator()() {
+        const uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotateLeft(state[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotateLeft(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t state[4];
+};
+
+/**
+ * Melissa O'Neill's PCG64 (the XSL RR output over a 128 bit linear congruential generator)
+ */
+class PCG64 {
+public:
+    explicit PCG64(uint64_t seed = 0) {
+        SplitMix64 seeder(seed);
+        increment = ((__uint128_t(seeder()) << 64) | seeder()) | 1; // the increment must be odd
+        state = (__uint128_t(seeder()) << 64) | seeder();
+        (*this)();
+    }
+
+    uint64_t operator()() {
+        const __uint128_t multiplier = (__uint128_t(2549297995355413924ull) << 64) | 4865540595714422341ull;
+        state = state * multiplier + increment;
+        const uint64_t xored = uint64_t(state >> 64) ^ uint64_t(state);
+        const unsigned int rotation = unsigned(state >> 122);
+        return (xored >> rotation) | (xored << ((64 - rotation) & 63));
+    }
+
+private:
+    __uint128_t state;
+    __uint128_t increment;
+};
+
+/**
+ * Salmon et al.'s Philox4x32-10. This is a counter-based generator: the value at any position is computed directly
+ * from the seed and the position, so any slice of a sequence can be generated on its own (and on its own thread)
+ */
+class Philox4x32 {
+public:
+    explicit Philox4x32(uint64_t seed = 0) : key0(uint32_t(seed)), key1(uint32_t(seed >> 32)) {}
+
+    /**
+     * @param counter The position in the sequence
+     * @param stream Picks one of 2^32 independent sequences from the same seed
+     * @return 64 random bits for that position
+     */
+    uint64_t operator()(uint64_t counter, uint32_t stream = 0) const {
+        uint32_t c0 = uint32_t(counter), c1 = uint32_t(counter >> 32), c2 = stream, c3 = 0;
+        uint32_t k0 = key0, k1 = key1;
+        for (unsigned int round = 0; round < 10; round++) {
+            const uint64_t product0 = uint64_t(0xD2511F53u) * c0;
+            const uint64_t product1 = uint64_t(0xCD9E8D57u) * c2;
+            c0 = uint32_t(product1 >> 32) ^ c1 ^ k0;
+            c1 = uint32_t(product1);
+            c2 = uint32_t(product0 >> 32) ^ c3 ^ k1;
+            c3 = uint32_t(product0);
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        return (uint64_t(c0) << 32) | c1;
+    }
+
+private:
+    uint32_t key0;
+    uint32_t key1;
+};
+
+/**
+ * Maps 64 random bits onto [0, range) with a multiply and shift. Unlike RandomNum::getRandomNumber() nothing is
+ * rejected, so one position of a counter-based sequence always gives one value. The bias this leaves is at most
+ * range / 2^64
+ * @param raw The random bits
+ * @param range How many values to map onto. 0 means the whole 64 bit range
+ */
+inline uint64_t scaleToRange(uint64_t raw, uint64_t range) {
+    if (range == 0) return raw;
+    return uint64_t((__uint128_t(raw) * range) >> 64);
+}
+
 /**
  * Initial class for holding all the Random Number generators
- * @tparam T defaults to unsigned 32 bit int. May use something different if preferred
+ * @tparam T defaults to unsigned 32 bit int. May use any unsigned integer type up to 64 bits
  */
 template <typename T = uint32_t>
 class RandomNum {
 public:
     //constructors and destructors
-    explicit RandomNum(T min = 0, T max = UINT32_MAX);
+    explicit RandomNum(T min = 0, T max = UINT32_MAX, uint64_t seed = newSeed(), RandomGenerator generator = philox);
     ~RandomNum() = default;
 
     //class members
     T getRandomNumber();
-    static bool randomBool();
+    bool randomBool();
+
+    static uint64_t newSeed();
 
 private:
-    std::mt19937 mersenneTwisterEngine;
-    std::uniform_int_distribution<T> uniIntDistribution;
+    uint64_t nextRaw();
+
+    RandomGenerator generator;
+    Philox4x32 philoxEngine;
+    uint64_t philoxCounter{0};
+    Xoshiro256StarStar xoshiroEngine;
+    PCG64 pcgEngine;
+    SplitMix64 splitMixEngine;
+    std::mt19937_64 mersenneTwisterEngine;
+    T min;
+    uint64_t range; // max - min + 1. 0 means the whole 64 bit range
 };
 
 /**
@@ -36,37 +200,75 @@ private:
  * @tparam T defaults to unsigned 32 bit int. May use something different if preferred
  * @param min The lower bound number to calculate the random number for each iteration
  * @param max The upper bound number to calculate the random number for each iteration
+ * @param seed The seed to start the generator from. The same seed and generator always give the same numbers
+ * @param generator Which generator to use
+ */
+template <typename T>
+RandomNum<T>::RandomNum(T min, T max, uint64_t seed, RandomGenerator generator)
+        : generator(generator), philoxEngine(seed), xoshiroEngine(seed), pcgEngine(seed), splitMixEngine(seed),
+          mersenneTwisterEngine(generator == mersenneTwister ? seed : std::mt19937_64::default_seed),
+          min(min), range(uint64_t(max - min) + 1) {}
+
+/**
+ * Draws a seed from the system's random device, for when the user didn't pass one
+ * @return A random 64 bit seed
+ */
+template <typename T>
+uint64_t RandomNum<T>::newSeed() {
+    std::random_device newRandomDevice;
+    return (uint64_t(newRandomDevice()) << 32) | newRandomDevice();
+}
+
+/**
+ * @return The next 64 random bits from the selected generator
  */
 template <typename T>
-RandomNum<T>::RandomNum(T min, T max) {
-    std::random_device newRandomDevice; //Will be used to obtain a seed for the random number engine
-    mersenneTwisterEngine = std::mt19937(newRandomDevice()); //Standard mersenne_twister_engine seeded with rd()
-    uniIntDistribution = std::uniform_int_distribution<T>(min, max);
-    //Clion raises a warning for this, however, we're not looking at generating a random sequence of numbers, just
-    //a random bool, making this less predictable that what Clion claims.
-    std::srand(time(0));
+inline uint64_t RandomNum<T>::nextRaw() {
+    switch (generator) {
+        case philox:
+            return philoxEngine(philoxCounter++);
+        case xoshiro256:
+            return xoshiroEngine();
+        case pcg64:
+            return pcgEngine();
+        case splitmix64:
+            return splitMixEngine();
+        default:
+            return mersenneTwisterEngine();
+    }
 }
 
 /**
- * Generates a new random number via the Mersenne Twister Engine
+ * Generates a new random number within the bounds set in the constructor. Uses Lemire's multiply and shift instead of
+ * std::uniform_int_distribution, whose output differs between standard libraries, so a seed gives the same numbers on
+ * every platform
  * @tparam T defaults to unsigned 32 bit int. May use something different if preferred
  * @return T object within the bounds set in the constructor
  */
 template <typename T>
 T RandomNum<T>::getRandomNumber() {
-    return uniIntDistribution(mersenneTwisterEngine);
+    if (range == 0) return static_cast<T>(nextRaw());
+    __uint128_t product = __uint128_t(nextRaw()) * range;
+    uint64_t low = uint64_t(product);
+    if (low < range) {
+        // reject the few values that would make the low end of the range slightly more likely
+        const uint64_t threshold = (0 - range) % range;
+        while (low < threshold) {
+            product = __uint128_t(nextRaw()) * range;
+            low = uint64_t(product);
+        }
+    }
+    return static_cast<T>(min + uint64_t(product >> 64));
 }
 
 /**
- * Generates a bool value of true or false at random with each iteration. Does NOT use the Mersenne Twister Engine
+ * Generates a bool value of true or false at random from the selected generator
  * @tparam T defaults to unsigned 32 bit int. May use something different if preferred
  * @return Either true or false at random
  */
 template <typename T>
 bool RandomNum<T>::randomBool() {
-    //Clion raises a warning for this, however, we're not looking at generating a random sequence of numbers, just
-    //a random bool, making this less predictable that what Clion claims.
-    return bool(std::rand() % 2);
+    return bool(nextRaw() >> 63);
 }
 
 #endif //ALGOGAUGE_RANDOMNUM_HPP
@@ -0,0 +1,447 @@
+/**
+ * @brief The formats the results can be written in. JSON is the default. Large sweeps can instead be written as a
+ * table with one row per sort: CSV, or a columnar binary format that analysis tools can load without parsing any
+ * text. Both are written as the sorts finish, through the same OutputBuffer as the JSON.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_RESULTWRITER_HPP
+#define ALGOGAUGE_RESULTWRITER_HPP
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "JSONWriter.hpp"
+#include "OutputBuffer.hpp"
+#include "../dependencies/PerfEvent.hpp"
+
+namespace Output {
+
+    /**
+     * @brief The format the results are written in
+     */
+    enum Format {
+        json = 0,
+        csv,
+        columnar
+    };
+
+    static const std::string FormatStrings[] = {
+            "json",
+            "csv",
+            "columnar"
+    };
+
+    const std::unordered_map<std::string, Format> formatMap = {
+            {"json", Format::json},
+            {"csv", Format::csv},
+            {"columnar", Format::columnar},
+            {"binary", Format::columnar}
+    };
+
+    /**
+     * The type of a column. The values are what the columnar format stores in its schema
+     */
+    enum ColumnType : uint8_t {
+        unsignedColumn = 0,
+        realColumn = 1,
+        textColumn = 2
+    };
+
+    struct Column {
+        std::string name;
+        ColumnType type;
+    };
+
+    /**
+     * The columns of the tables, in order: one for each value of a sort's result, with the members of nested objects
+     * named object.member. They are declared here rather than taken from the results, so every table has the same
+     * schema whatever the first sort measured, and a value a sort doesn't have is null
+     */
+    inline const std::vector<Column> &resultColumns() {
+        static const std::vector<Column> columns = [] {
+            std::vector<Column> list = {
+                    {"algorithmName", textColumn},
+                    {"algorithmOption", textColumn},
+                    {"algorithmLength", unsignedColumn},
+                    {"algorithmOptionParameter", realColumn},
+                    {"algorithmInputFile", textColumn},
+                    {"language", textColumn},
+                    {"algorithmCanonicalName", textColumn},
+                    {"algorithmThreads", unsignedColumn},
+                    {"algorithmKeyType", textColumn},
+                    {"algorithmElementBytes", unsignedColumn},
+                    {"algorithmSeed", unsignedColumn},
+                    {"algorithmGenerator", textColumn},
+                    {"algorithmMemoryPolicy", textColumn},
+                    {"algorithmTimer", textColumn},
+                    {"algorithmCpus", textColumn},
+                    {"algorithmCpuGovernor", textColumn},
+                    {"algorithmContextSwitches", unsignedColumn},
+                    {"algorithmCpuMigrations", unsignedColumn},
+                    {"algorithmRunTime_ms", realColumn},
+                    {"algorithmOperationCounts.comparisons", unsignedColumn},
+                    {"algorithmOperationCounts.swaps", unsignedColumn},
+                    {"algorithmOperationCounts.moves", unsignedColumn},
+                    {"algorithmOperationCounts.bytesAllocated", unsignedColumn},
+                    {"algorithmOperationCounts.scratchBytes", unsignedColumn},
+                    {"algorithmRepetitions", unsignedColumn},
+                    {"algorithmWarmups", unsignedColumn},
+                    {"algorithmRunTimeStats_ms.min", realColumn},
+                    {"algorithmRunTimeStats_ms.median", realColumn},
+                    {"algorithmRunTimeStats_ms.mean", realColumn},
+                    {"algorithmRunTimeStats_ms.stddev", realColumn},
+                    {"algorithmRunTimeStats_ms.p95", realColumn}
+            };
+            for (const std::string &name : PerfEvent::getReportNames()) list.push_back({"perfData." + name, realColumn});
+            return list;
+        }();
+        return columns;
+    }
+
+    /**
+     * @return The index of the named column in resultColumns()
+     * @throws std::invalid_argument if there is no such column
+     */
+    inline size_t columnIndex(const std::string &name) {
+        static const std::unordered_map<std::string, size_t> indexes = [] {
+            std::unordered_map<std::string, size_t> map;
+            for (size_t i = 0; i < resultColumns().size(); i++) map.emplace(resultColumns()[i].name, i);
+            return map;
+        }();
+        auto it = indexes.find(name);
+        if (it == indexes.end()) throw std::invalid_argument("\"" + name + "\" is not a column of the results table");
+        return it->second;
+    }
+
+    struct Field {
+        bool present{false}; // false for null
+        uint64_t number{0};
+        double real{0};
+        std::string text;
+    };
+
+    /**
+     * One result, as a value for each of resultColumns(). Every value starts out null
+     */
+    class Row {
+    public:
+        Row() : fields(resultColumns().size()) {}
+
+        Row &setNumber(const std::string &name, uint64_t value) {
+            Field &field = at(name, unsignedColumn);
+            field.present = true;
+            field.number = value;
+            return *this;
+        }
+        Row &setReal(const std::string &name, double value) { // NaN and infinity are null, as they are in the JSON
+            Field &field = at(name, realColumn);
+            field.present = std::isfinite(value);
+            field.real = value;
+            return *this;
+        }
+        Row &setText(const std::string &name, std::string value) {
+            Field &field = at(name, textColumn);
+            field.present = true;
+            field.text = std::move(value);
+            return *this;
+        }
+        const std::vector<Field> &getFields() const { return fields; }
+
+    private:
+        /**
+         * @throws std::invalid_argument if the column doesn't exist or holds another type
+         */
+        Field &at(const std::string &name, ColumnType type) {
+            const size_t column = columnIndex(name);
+            if (resultColumns()[column].type != type) throw std::invalid_argument("\"" + name + "\" is set with the wrong type");
+            return fields[column];
+        }
+
+        std::vector<Field> fields;
+    };
+
+    /**
+     * Writes rows into a table whose columns are resultColumns(). The schema is written before the first row, or by
+     * finish() when there are none
+     */
+    class TableWriter {
+    public:
+        explicit TableWriter(std::vector<std::FILE *> sinks) : columns(resultColumns()), output(std::move(sinks)) {}
+        virtual ~TableWriter() = default;
+
+        void writeRow(const Row &row) {
+            startTable();
+            writeValues(row.getFields());
+        }
+
+        /**
+         * Writes anything the format holds back until the end, and hands it all to the sinks
+         */
+        virtual void finish() {
+            startTable();
+            output.flush();
+        }
+
+        /**
+         * Hands the rows written so far to the sinks, when a run fails part way through. Every row is complete, so
+         * only the formats that end with a marker need to leave it out
+         */
+        virtual void abandon() { output.flush(); }
+
+    protected:
+        virtual void writeSchema() = 0;
+
+        /**
+         * @param values The value for each column
+         */
+        virtual void writeValues(const std::vector<Field> &values) = 0;
+
+        void startTable() {
+            if (schemaDone) return;
+            writeSchema();
+            schemaDone = true;
+        }
+
+        bool schemaWritten() const { return schemaDone; }
+
+        const std::vector<Column> &columns;
+        OutputBuffer output;
+
+    private:
+        bool schemaDone{false};
+    };
+
+    /**
+     * CSV as RFC 4180 describes it: a header row of the column names, and null as an empty value. Reals are written
+     * in the fewest digits that read back as the same double
+     */
+    class CSVWriter : public TableWriter {
+    public:
+        using TableWriter::TableWriter;
+
+    protected:
+        void writeSchema() override {
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (i > 0) output.write(",");
+                writeText(columns[i].name);
+            }
+            output.write("\n");
+        }
+
+        void writeValues(const std::vector<Field> &values) override {
+            for (size_t i = 0; i < values.size(); i++) {
+                if (i > 0) output.write(",");
+                const Field &field = values[i];
+                if (!field.present) continue;
+                if (columns[i].type == textColumn) {
+                    writeText(field.text);
+                    continue;
+                }
+                char *position = output.reserve(32);
+                if (columns[i].type == unsignedColumn) output.commit(std::to_chars(position, position + 32, field.number).ptr);
+                else output.commit(std::to_chars(position, position + 32, field.real).ptr);
+            }
+            output.write("\n");
+        }
+
+    private:
+        /**
+         * Writes text as it is, or quoted with its quotes doubled when it holds a comma, quote or line break
+         */
+        void writeText(std::string_view text) {
+            if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+                output.write(text);
+                return;
+            }
+            output.write("\"");
+            size_t start = 0;
+            for (size_t quote = text.find('"'); quote != std::string_view::npos; quote = text.find('"', start)) {
+                output.write(text.substr(start, quote + 1 - start));
+                output.write("\"");
+                start = quote + 1;
+            }
+            output.write(text.substr(start));
+            output.write("\"");
+        }
+    };
+
+    /**
+     * A compact binary table, stored a column at a time so a column can be loaded straight into an array. Rows are
+     * collected into blocks of blockRows, so the table is still written as the sorts finish. Everything is little
+     * endian:
+     *
+     *   "AGCOLUMN", uint32 version (1), uint32 column count, then each column's uint8 type (ColumnType), uint32 name
+     *   length and name. Then the blocks, each a uint32 row count followed by every column in schema order:
+     *   a validity bitmap of (rows + 7) / 8 bytes (bit i % 8 of byte i / 8 is set when row i isn't null), then the
+     *   values. Unsigned and real columns are one uint64 or double per row (0 when null). Text columns repeat the
+     *   same few values (names, strategies, generators), so they are stored as a dictionary of the block's distinct
+     *   values: a uint32 count n, n + 1 uint32 offsets into the dictionary's text, then the text (value j is the bytes
+     *   from offset j to offset j + 1), then one uint32 index into the dictionary per row (0 when null).
+     *   A row count of 0 ends the table, so a table cut short can be told apart from a complete one
+     */
+    class ColumnarWriter : public TableWriter {
+    public:
+        static constexpr uint32_t version = 1;
+        static constexpr uint32_t blockRows = 4096;
+
+        using TableWriter::TableWriter;
+
+        void finish() override {
+            startTable();
+            writeBlock();
+            writeInteger(uint32_t(0));
+            TableWriter::finish();
+        }
+
+        /**
+         * Writes the rows collected so far, but not the row count of 0, so the table reads as cut short
+         */
+        void abandon() override {
+            if (schemaWritten()) writeBlock();
+            TableWriter::abandon();
+        }
+
+    protected:
+        void writeSchema() override {
+            output.write("AGCOLUMN");
+            writeInteger(version);
+            writeInteger(uint32_t(columns.size()));
+            for (const Column &column : columns) {
+                writeInteger(uint8_t(column.type));
+                writeInteger(uint32_t(column.name.size()));
+                output.write(column.name);
+            }
+            blocks.resize(columns.size());
+            for (ColumnBlock &block : blocks) block.offsets.push_back(0);
+        }
+
+        void writeValues(const std::vector<Field> &values) override {
+            for (size_t i = 0; i < values.size(); i++) {
+                const Field &field = values[i];
+                const bool present = field.present;
+                ColumnBlock &block = blocks[i];
+                if (rows % 8 == 0) block.validity.push_back(0);
+                if (present) block.validity.back() |= uint8_t(1u << (rows % 8));
+                if (columns[i].type == textColumn) {
+                    uint32_t index = 0;
+                    if (present) {
+                        auto entry = block.dictionary.emplace(field.text, uint32_t(block.dictionary.size()));
+                        if (entry.second) {
+                            block.text += field.text;
+                            block.offsets.push_back(uint32_t(block.text.size()));
+                        }
+                        index = entry.first->second;
+                    }
+                    block.values.push_back(index);
+                } else if (columns[i].type == realColumn) {
+                    uint64_t bits = 0;
+                    if (present) std::memcpy(&bits, &field.real, sizeof(bits));
+                    block.values.push_back(bits);
+                } else {
+                    block.values.push_back(present ? field.number : 0);
+                }
+            }
+            if (++rows == blockRows) writeBlock();
+        }
+
+    private:
+        struct ColumnBlock {
+            std::vector<uint8_t> validity;
+            std::vector<uint64_t> values; // or the dictionary indexes of a text column
+            std::unordered_map<std::string, uint32_t> dictionary; // the text column's distinct values, and their indexes
+            std::vector<uint32_t> offsets;
+            std::string text;
+        };
+
+        template<typename Integer>
+        void writeInteger(Integer value) {
+            char *position = output.reserve(sizeof(Integer));
+            for (size_t byte = 0; byte < sizeof(Integer); byte++) position[byte] = char(uint64_t(value) >> (8 * byte));
+            output.commit(position + sizeof(Integer));
+        }
+
+        void writeBlock() {
+            if (rows == 0) return;
+            writeInteger(rows);
+            for (size_t i = 0; i < blocks.size(); i++) {
+                ColumnBlock &block = blocks[i];
+                output.write(block.validity.data(), block.validity.size());
+                if (columns[i].type == textColumn) {
+                    writeInteger(uint32_t(block.dictionary.size()));
+                    for (uint32_t offset : block.offsets) writeInteger(offset);
+                    output.write(block.text);
+                    for (uint64_t index : block.values) writeInteger(uint32_t(index));
+                } else {
+                    for (uint64_t value : block.values) writeInteger(value);
+                }
+                block.validity.clear();
+                block.values.clear();
+                block.dictionary.clear();
+                block.offsets.assign(1, 0);
+                block.text.clear();
+            }
+            rows = 0;
+        }
+
+        std::vector<ColumnBlock> blocks;
+        uint32_t rows{0}; // in the block being collected
+    };
+
+    /**
+     * Writes the results in the selected format. JSON is written through json(), and the tables through writeRow()
+     */
+    class ResultWriter {
+    public:
+        ResultWriter(Format format, std::vector<std::FILE *> sinks) : format(format) {
+            if (format == csv) table = std::make_unique<CSVWriter>(std::move(sinks));
+            else if (format == columnar) table = std::make_unique<ColumnarWriter>(std::move(sinks));
+            else jsonWriter = std::make_unique<JSONWriter>(std::move(sinks));
+        }
+
+        Format getFormat() const { return format; }
+        JSONWriter &json() { return *jsonWriter; }
+        void writeRow(const Row &row) { table->writeRow(row); }
+
+        /**
+         * Hands everything to the sinks, once every result is written
+         * @throws std::runtime_error if a sink couldn't be written to
+         */
+        void finish() {
+            if (table) table->finish();
+            else jsonWriter->flush();
+        }
+
+        /**
+         * Hands the results written so far to the sinks when a run fails part way through, closed off so they
+         * still parse: the JSON's open arrays and objects are closed, and the tables end after their last row
+         * @throws std::runtime_error if a sink couldn't be written to
+         */
+        void abandon() {
+            if (table) table->abandon();
+            else {
+                jsonWriter->closeAll();
+                jsonWriter->flush();
+            }
+        }
+
+    private:
+        Format format;
+        std::unique_ptr<JSONWriter> jsonWriter;
+        std::unique_ptr<TableWriter> table;
+    };
+
+} // namespace Output
+
+#endif //ALGOGAUGE_RESULTWRITER_HPP
@@ -0,0 +1,231 @@
+/**
+ * @brief Bitonic sorting network kernels for small blocks (up to 64) of unsigned 32 bit ints. There is an AVX2, an
+ * SSE4.1 and a scalar version of the same network. The best kernel the CPU supports is picked at runtime, so the
+ * program doesn't need to be compiled with -mavx2 to use it.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_SORTINGNETWORKS_HPP
+#define ALGOGAUGE_SORTINGNETWORKS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ALGOGAUGE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace SortingNetworks {
+
+    /**
+     * @brief The largest block the kernels can sort in one call
+     */
+    constexpr unsigned int maxBlockSize = 64;
+
+    /**
+     * @brief Which instruction set a kernel uses
+     */
+    enum Kernel {
+        scalar = 0,
+        sse41,
+        avx2
+    };
+
+    static const std::string KernelStrings[] = {
+            "scalar",
+            "sse4.1",
+            "avx2"
+    };
+
+    /**
+     * Runs the bitonic network over a power of two sized block, one compare-exchange at a time. Written with
+     * std::min/std::max so the compiler emits conditional moves instead of branches.
+     * @param block The values to sort in place
+     * @param size The block size. Must be a power of two
+     */
+    inline void bitonicScalar(uint32_t *block, unsigned int size) {
+        for (unsigned int k = 2; k <= size; k <<= 1) {
+            for (unsigned int j = k >> 1; j > 0; j >>= 1) {
+                for (unsigned int i = 0; i < size; i++) {
+                    unsigned int partner = i ^ j;
+                    if (partner <= i) continue;
+                    uint32_t low = std::min(block[i], block[partner]);
+                    uint32_t high = std::max(block[i], block[partner]);
+                    bool ascending = (i & k) == 0;
+                    block[i] = ascending ? low : high;
+                    block[partner] = ascending ? high : low;
+                }
+            }
+        }
+    }
+
+#ifdef ALGOGAUGE_X86_SIMD
+
+    /**
+     * The same network as bitonicScalar() with 8 lanes per register. Compare-exchanges between lanes that are at
+     * least 8 apart are a plain min/max of two registers. Closer lanes are permuted within the register, and a blend
+     * picks the min or max for each lane.
+     * @param block The values to sort in place
+     * @param size The block size. Must be a power of two and at least 8
+     */
+    __attribute__((target("avx2")))
+    inline void bitonicAVX2(uint32_t *block, unsigned int size) {
+        __m256i registers[maxBlockSize / 8];
+        const unsigned int registerCount = size / 8;
+        for (unsigned int r = 0; r < registerCount; r++) {
+            registers[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 8 * r));
+        }
+
+        const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i zero = _mm256_setzero_si256();
+
+        for (unsigned int k = 2; k <= size; k <<= 1) {
+            for (unsigned int j = k >> 1; j > 0; j >>= 1) {
+                if (j >= 8) {
+                    // partners sit in different registers and the direction is the same for the whole register
+                    for (unsigned int r = 0; r < registerCount; r++) {
+                        unsigned int partner = r ^ (j / 8);
+                        if (partner < r) continue;
+                        __m256i low = _mm256_min_epu32(registers[r], registers[partner]);
+                        __m256i high = _mm256_max_epu32(registers[r], registers[partner]);
+                        bool ascending = ((8 * r) & k) == 0;
+                        registers[r] = ascending ? low : high;
+                        registers[partner] = ascending ? high : low;
+                    }
+                    continue;
+                }
+
+                const __m256i partnerLanes = _mm256_xor_si256(laneIndex, _mm256_set1_epi32(static_cast<int>(j)));
+                const __m256i jMask = _mm256_set1_epi32(static_cast<int>(j));
+                const __m256i kMask = _mm256_set1_epi32(static_cast<int>(k));
+                for (unsigned int r = 0; r < registerCount; r++) {
+                    __m256i index = _mm256_add_epi32(laneIndex, _mm256_set1_epi32(static_cast<int>(8 * r)));
+                    __m256i swapped = _mm256_permutevar8x32_epi32(registers[r], partnerLanes);
+                    __m256i low = _mm256_min_epu32(registers[r], swapped);
+                    __m256i high = _mm256_max_epu32(registers[r], swapped);
+                    // a lane keeps the min when it is the lower lane of an ascending pair or the upper of a descending one
+                    __m256i isLowerLane = _mm256_cmpeq_epi32(_mm256_and_si256(index, jMask), zero);
+                    __m256i isAscending = _mm256_cmpeq_epi32(_mm256_and_si256(index, kMask), zero);
+                    __m256i takeLow = _mm256_cmpeq_epi32(isLowerLane, isAscending);
+                    registers[r] = _mm256_blendv_epi8(high, low, takeLow);
+                }
+            }
+        }
+
+        for (unsigned int r = 0; r < registerCount; r++) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(block + 8 * r), registers[r]);
+        }
+    }
+
+    /**
+     * The same network as bitonicAVX2() with 4 lanes per register.
+     * @param block The values to sort in place
+     * @param size The block size. Must be a power of two and at least 4
+     */
+    __attribute__((target("sse4.1")))
+    inline void bitonicSSE41(uint32_t *block, unsigned int size) {
+        __m128i registers[maxBlockSize / 4];
+        const unsigned int registerCount = size / 4;
+        for (unsigned int r = 0; r < registerCount; r++) {
+            registers[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 4 * r));
+        }
+
+        const __m128i laneIndex = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128i zero = _mm_setzero_si128();
+
+        for (unsigned int k = 2; k <= size; k <<= 1) {
+            for (unsigned int j = k >> 1; j > 0; j >>= 1) {
+                if (j >= 4) {
+                    for (unsigned int r = 0; r < registerCount; r++) {
+                        unsigned int partner = r ^ (j / 4);
+                        if (partner < r) continue;
+                        __m128i low = _mm_min_epu32(registers[r], registers[partner]);
+                        __m128i high = _mm_max_epu32(registers[r], registers[partner]);
+                        bool ascending = ((4 * r) & k) == 0;
+                        registers[r] = ascending ? low : high;
+                        registers[partner] = ascending ? high : low;
+                    }
+                    continue;
+                }
+
+                const __m128i jMask = _mm_set1_epi32(static_cast<int>(j));
+                const __m128i kMask = _mm_set1_epi32(static_cast<int>(k));
+                for (unsigned int r = 0; r < registerCount; r++) {
+                    __m128i index = _mm_add_epi32(laneIndex, _mm_set1_epi32(static_cast<int>(4 * r)));
+                    __m128i swapped = j == 1
+                            ? _mm_shuffle_epi32(registers[r], _MM_SHUFFLE(2, 3, 0, 1))
+                            : _mm_shuffle_epi32(registers[r], _MM_SHUFFLE(1, 0, 3, 2));
+                    __m128i low = _mm_min_epu32(registers[r], swapped);
+                    __m128i high = _mm_max_epu32(registers[r], swapped);
+                    __m128i isLowerLane = _mm_cmpeq_epi32(_mm_and_si128(index, jMask), zero);
+                    __m128i isAscending = _mm_cmpeq_epi32(_mm_and_si128(index, kMask), zero);
+                    __m128i takeLow = _mm_cmpeq_epi32(isLowerLane, isAscending);
+                    registers[r] = _mm_blendv_epi8(high, low, takeLow);
+                }
+            }
+        }
+
+        for (unsigned int r = 0; r < registerCount; r++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(block + 4 * r), registers[r]);
+        }
+    }
+
+#endif
+
+    /**
+     * @return The fastest kernel this CPU supports
+     */
+    inline Kernel detectKernel() {
+#ifdef ALGOGAUGE_X86_SIMD
+        if (__builtin_cpu_supports("avx2")) return avx2;
+        if (__builtin_cpu_supports("sse4.1")) return sse41;
+#endif
+        return scalar;
+    }
+
+    /**
+     * Sorts up to 64 values with the requested kernel. The values are padded with UINT32_MAX up to the next power of
+     * two (8 at the least), sorted, and the first size values are copied back.
+     * @param values The values to sort in place
+     * @param size How many values to sort. Must not be larger than maxBlockSize
+     * @param kernel Which kernel to run. Must be supported by this CPU (see detectKernel())
+     */
+    inline void sortBlock(uint32_t *values, unsigned int size, Kernel kernel) {
+        if (size < 2) return;
+        unsigned int paddedSize = 8;
+        while (paddedSize < size) paddedSize <<= 1;
+
+        alignas(32) uint32_t block[maxBlockSize];
+        std::copy(values, values + size, block);
+        std::fill(block + size, block + paddedSize, UINT32_MAX);
+
+        switch (kernel) {
+#ifdef ALGOGAUGE_X86_SIMD
+            case avx2:
+                bitonicAVX2(block, paddedSize);
+                break;
+            case sse41:
+                bitonicSSE41(block, paddedSize);
+                break;
+#endif
+            default:
+                bitonicScalar(block, paddedSize);
+        }
+
+        std::copy(block, block + size, values);
+    }
+
+    /**
+     * Sorts up to 64 values with the fastest kernel this CPU supports
+     */
+    inline void sortBlock(uint32_t *values, unsigned int size) {
+        static const Kernel bestKernel = detectKernel();
+        sortBlock(values, size, bestKernel);
+    }
+
+} // namespace SortingNetworks
+
+#endif //ALGOGAUGE_SORTINGNETWORKS_HPP
@@ -0,0 +1,159 @@
+/**
+ * @brief A small fork/join thread pool used by the parallel sorting algorithms. Threads that wait on their forked
+ * tasks help run queued tasks instead of blocking, so recursive algorithms can't deadlock the pool.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_THREADPOOL_HPP
+#define ALGOGAUGE_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+/**
+ * Fixed size pool of worker threads. The calling thread counts as one of the threads, so a pool of size 1 spawns no
+ * workers and runs every task inline while waiting.
+ */
+class ThreadPool {
+public:
+    //constructors and destructors
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    //class members
+    unsigned int size() const { return threadCount; }
+    void submit(std::function<void()> task, std::atomic<unsigned int> &pending);
+    void wait(std::atomic<unsigned int> &pending);
+
+    static unsigned int resolveThreadCount(unsigned int requested);
+
+private:
+    bool runPendingTask();
+    void workerLoop();
+
+    unsigned int threadCount{1};
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksAvailable;
+    bool stopping{false};
+};
+
+/**
+ * Only constructor for this class
+ * @param threadCount The total number of threads to use, including the caller. 0 uses every CPU the program may run on
+ */
+inline ThreadPool::ThreadPool(unsigned int threadCount) {
+    this->threadCount = resolveThreadCount(threadCount);
+    for (unsigned int i = 1; i < this->threadCount; i++) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+/**
+ * Stops and joins every worker. Any tasks still queued are dropped, so callers must wait() on their tasks first
+ */
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    tasksAvailable.notify_all();
+    for (auto &worker : workers) worker.join();
+}
+
+/**
+ * Converts a requested thread count into the number of threads that will actually be used. The default counts the
+ * CPUs in the affinity mask rather than the machine's, so a program limited by --pin-cpu, taskset or a container's
+ * cpuset doesn't start more threads than it has CPUs to run them on
+ * @param requested The number of threads asked for. 0 means one for every CPU the program may run on
+ * @return The resolved thread count (always at least 1)
+ */
+inline unsigned int ThreadPool::resolveThreadCount(unsigned int requested) {
+    if (requested > 0) return requested;
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0 && CPU_COUNT(&allowed) > 0) {
+        return static_cast<unsigned int>(CPU_COUNT(&allowed));
+    }
+#endif
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 0 ? hardwareThreads : 1;
+}
+
+/**
+ * Queues a task to be run by any thread in the pool
+ * @param task The work to run
+ * @param pending Counter shared by a group of tasks. It is incremented here and decremented once the task finishes
+ */
+inline void ThreadPool::submit(std::function<void()> task, std::atomic<unsigned int> &pending) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.emplace_back([task = std::move(task), &pending] {
+            task();
+            pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+    tasksAvailable.notify_one();
+}
+
+/**
+ * Waits until every task submitted against the pending counter has finished. While waiting, the calling thread runs
+ * queued tasks itself rather than sitting idle.
+ * @param pending The counter that was passed to submit()
+ */
+inline void ThreadPool::wait(std::atomic<unsigned int> &pending) {
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!runPendingTask()) std::this_thread::yield();
+    }
+}
+
+/**
+ * Pops and runs the most recently queued task, if any
+ * @return true if a task was run
+ */
+inline bool ThreadPool::runPendingTask() {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        if (tasks.empty()) return false;
+        // newest first keeps the waiting thread working on its own (hot in cache) sub-problem
+        task = std::move(tasks.back());
+        tasks.pop_back();
+    }
+    task();
+    return true;
+}
+
+/**
+ * Main loop for each worker thread. Workers take the oldest task, which is usually the largest piece of work.
+ */
+inline void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+#endif //ALGOGAUGE_THREADPOOL_HPP
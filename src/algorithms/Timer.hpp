@@ -0,0 +1,195 @@
+/**
+ * @brief The clock every benchmark is timed with. Besides std::chrono::steady_clock (a clock_gettime call on Linux)
+ * there is the CPU's own tick counter: rdtscp on x86 and cntvct_el0 on ARM. Reading it takes a few nanoseconds, so it
+ * can time operations that only take a few hundred. It is calibrated against steady_clock once when selected, and the
+ * cost of reading it is measured and taken off every measurement.
+ * @authors Brad Peterson Ph.D., John Z. DeGrey, et al.
+ * @copyright Weber State University
+ */
+
+#ifndef ALGOGAUGE_TIMER_HPP
+#define ALGOGAUGE_TIMER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ALGOGAUGE_X86_TSC 1
+#include <cpuid.h>
+#include <x86intrin.h>
+#elif defined(__aarch64__) && defined(__GNUC__)
+#define ALGOGAUGE_ARM_COUNTER 1
+#endif
+
+namespace Timing {
+
+    /**
+     * @brief Which clock the benchmarks are timed with
+     */
+    enum Clock {
+        steadyClock = 0,
+        tickCounter
+    };
+
+    static const std::string ClockStrings[] = { // the same names --timer takes, so a reported clock can be passed back
+            "steady",
+            "tsc"
+    };
+
+    const std::unordered_map<std::string, Clock> clockMap = {
+            {"steady", Clock::steadyClock},
+            {"tsc", Clock::tickCounter}
+    };
+
+    /**
+     * @return The CPU's tick counter. rdtscp waits for every earlier instruction to finish and the lfence stops later
+     * ones from starting early, so nothing leaks into or out of the timed region
+     */
+    inline uint64_t readTicks() {
+#if defined(ALGOGAUGE_X86_TSC)
+        unsigned int processor;
+        const uint64_t ticks = __rdtscp(&processor);
+        _mm_lfence();
+        return ticks;
+#elif defined(ALGOGAUGE_ARM_COUNTER)
+        uint64_t ticks;
+        asm volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks) :: "memory");
+        return ticks;
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @return Whether the CPU has a tick counter that runs at a constant rate, whatever the core's frequency
+     */
+    inline bool ticksAvailable() {
+#if defined(ALGOGAUGE_X86_TSC)
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 27))) return false; // rdtscp
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) return false; // invariant TSC
+        return true;
+#elif defined(ALGOGAUGE_ARM_COUNTER)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Reads whichever clock was selected, and turns two readings into milliseconds. There is one Timer for the whole
+     * program (see global()), selected once before anything is timed
+     */
+    class Timer {
+    public:
+        static Timer &global();
+
+        void select(Clock requested);
+        Clock getClock() const { return clock; }
+        std::string getClockName() const { return ClockStrings[clock]; }
+        double getTicksPerSecond() const { return ticksPerSecond; }
+        double getOverheadNanoseconds() const { return overheadTicks / ticksPerSecond * 1e9; }
+
+        /**
+         * @return The current time, in ticks of the selected clock
+         */
+        uint64_t now() const {
+            if (clock == tickCounter) return readTicks();
+            return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        /**
+         * @param start A reading from now() taken before the timed code
+         * @param stop A reading from now() taken after it
+         * @return The milliseconds between them, less the cost of reading the clock (never less than 0)
+         */
+        double toMilliseconds(uint64_t start, uint64_t stop) const {
+            const double ticks = double(stop - start) - overheadTicks;
+            return ticks > 0 ? ticks / ticksPerSecond * 1e3 : 0;
+        }
+
+    private:
+        Timer() = default;
+        double measureOverhead() const;
+        static double calibrateTicksPerSecond();
+
+        Clock clock{steadyClock};
+        double ticksPerSecond{1e9}; // steady_clock is read in nanoseconds
+        double overheadTicks{0};
+    };
+
+    inline Timer &Timer::global() {
+        static Timer timer;
+        return timer;
+    }
+
+    /**
+     * Switches to a clock. The tick counter is calibrated and its overhead measured here, which takes about 30ms.
+     * steady_clock is left exactly as it always was, with no overhead taken off
+     * @param requested The clock to use. Falls back to steady_clock (with a warning) if the CPU has no usable tick
+     * counter
+     */
+    inline void Timer::select(Clock requested) {
+        if (requested == tickCounter && !ticksAvailable()) {
+            std::cerr << "Warning: this CPU has no constant rate tick counter, so steady_clock is used instead" << std::endl;
+            requested = steadyClock;
+        }
+        clock = requested;
+        overheadTicks = 0;
+        if (clock == steadyClock) {
+            ticksPerSecond = 1e9;
+            return;
+        }
+        ticksPerSecond = calibrateTicksPerSecond();
+        overheadTicks = measureOverhead();
+    }
+
+    /**
+     * Counts the ticks in three 10ms spans of steady_clock and takes the middle rate, so one span that was interrupted
+     * can't throw it off. ARM reports its counter's frequency, so there's nothing to measure there
+     * @return Ticks per second of the tick counter
+     */
+    inline double Timer::calibrateTicksPerSecond() {
+#if defined(ALGOGAUGE_ARM_COUNTER)
+        uint64_t frequency;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+        return double(frequency);
+#else
+        std::vector<double> rates;
+        for (int span = 0; span < 3; span++) {
+            const auto startTime = std::chrono::steady_clock::now();
+            const uint64_t startTicks = readTicks();
+            auto stopTime = startTime;
+            while (stopTime - startTime < std::chrono::milliseconds(10)) stopTime = std::chrono::steady_clock::now();
+            const uint64_t stopTicks = readTicks();
+            rates.push_back(double(stopTicks - startTicks) / std::chrono::duration<double>(stopTime - startTime).count());
+        }
+        std::sort(rates.begin(), rates.end());
+        return rates[1];
+#endif
+    }
+
+    /**
+     * Times back to back readings of the clock. The smallest gap is what reading the clock costs on its own, as
+     * anything more comes from an interrupt or a cache miss
+     * @return The overhead in ticks
+     */
+    inline double Timer::measureOverhead() const {
+        uint64_t smallest = UINT64_MAX;
+        for (int i = 0; i < 1000; i++) {
+            const uint64_t start = now();
+            const uint64_t stop = now();
+            smallest = std::min(smallest, stop - start);
+        }
+        return double(smallest);
+    }
+
+} // namespace Timing
+
+#endif //ALGOGAUGE_TIMER_HPP
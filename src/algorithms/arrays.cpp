@@ -17,6 +17,7 @@
 #include <chrono>
 #include <utility>
 #include "RandomNum.hpp"
+#include "Timer.hpp"
 #include "../dependencies/PerfEvent.hpp"
 
 using std::cout;
@@ -199,8 +200,10 @@ string ArrayPerformanceTest(int capacity, int number, string function, string pe
         cout << "Array has been created, Beginning timer and Perf" << endl;
     }
 
-    auto sTime = std::chrono::high_resolution_clock::now();
+    // perf is started first and stopped last, so its system calls aren't timed along with the operations
     perfObject.startCounters();
+    const Timing::Timer &timer = Timing::Timer::global();
+    const uint64_t sTime = timer.now();
 
     if (function == "pop_back") {
         ArrayPopBackTime(array, number);
@@ -226,8 +229,8 @@ string ArrayPerformanceTest(int capacity, int number, string function, string pe
         std::cerr << "Invalid function name given" << endl;
     }
 
-    auto eTime = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double, std::milli> fp_ms = eTime - sTime;
+    const uint64_t eTime = timer.now();
+    std::chrono::duration<double, std::milli> fp_ms(timer.toMilliseconds(sTime, eTime));
     perfObject.stopCounters();
 
     if (includeValues) {
@@ -239,7 +242,8 @@ string ArrayPerformanceTest(int capacity, int number, string function, string pe
     output += R"("nodeCount": )" + std::to_string(capacity) + ",";
     output += "\"type\": \"array\",";
     output += R"("number": )" + std::to_string(number) + ",";
-    output += R"("algorithmRunTime_ms": )" + std::to_string(fp_ms.count());
+    output += R"("algorithmRunTime_ms": )" + std::to_string(fp_ms.count()) + ",";
+    output += R"("algorithmTimer": ")" + timer.getClockName() + "\"";
 
     std::transform(perf.begin(), perf.end(), perf.begin(), ::tolower);
 
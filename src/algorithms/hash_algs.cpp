@@ -14,6 +14,7 @@
 #include <chrono>
 #include <utility>
 #include "RandomNum.hpp"
+#include "Timer.hpp"
 #include "../dependencies/PerfEvent.hpp"
 
 using std::cout;
@@ -331,13 +332,15 @@ namespace HashTables {
   string runHash(ClosedHashTable<T, U> &&hashObj) {
     PerfEvent perfObject;
     if (hashObj.getVerbose()) cout << "starting timer..." << endl;
-    auto t1 = std::chrono::high_resolution_clock::now();
+    const Timing::Timer &timer = Timing::Timer::global();
+    // perf is started first and stopped last, so its system calls aren't timed along with the operations
     perfObject.startCounters();
+    const uint64_t t1 = timer.now();
     hashObj.crudOperation(hashObj.getCRUDTestAmount());
+    const uint64_t t2 = timer.now();
     perfObject.stopCounters();
-    auto t2 = std::chrono::high_resolution_clock::now();
     if (hashObj.getVerbose()) cout << "stopping timer..." << endl;
-    std::chrono::duration<double, std::milli> fp_ms = t2 - t1;
+    std::chrono::duration<double, std::milli> fp_ms(timer.toMilliseconds(t1, t2));
     if (hashObj.getVerbose()) cout << "Algorithm ran for " + std::to_string(fp_ms.count()) + "ms." << endl;
 
     string output;
@@ -346,6 +349,7 @@ namespace HashTables {
     output += "\"language\": \"C++\", "; 
     output += "\"probingType\": \"" + hashObj.getProbingType() + "\", ";
     output += "\"algorithmRunTime_ms\": " + std::to_string(fp_ms.count()) + ", ";
+    output += "\"algorithmTimer\": \"" + timer.getClockName() + "\", ";
     output += "\"density\": " + std::to_string(hashObj.getAmountFilled()) + ", ";
     output += "\"number\": " + std::to_string(hashObj.getCRUDTestAmount()) + ", ";
     output += "\"perfData\": "; //always return the perf data object regardless. If no perf data, perf object will just be empty
@@ -17,6 +17,7 @@
 #include <chrono>
 #include <utility>
 #include "RandomNum.hpp"
+#include "Timer.hpp"
 #include "../dependencies/PerfEvent.hpp"
 
 using std::cout;
@@ -198,12 +199,13 @@ std::string LinkedListPerformanceTest(int size, int number, string function, str
         list.print_List();
     }
 
-    //start time
-    auto sTime = std::chrono::high_resolution_clock::now();
-
-    //start perf
+    //start perf. It is started first and stopped last, so its system calls aren't timed along with the operations
     perfObject.startCounters();
 
+    //start time
+    const Timing::Timer &timer = Timing::Timer::global();
+    const uint64_t sTime = timer.now();
+
     //function check
 
     if(function == "pop_back"){
@@ -228,8 +230,8 @@ std::string LinkedListPerformanceTest(int size, int number, string function, str
     }
 
     //end time
-    auto eTime = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double, std::milli> fp_ms = eTime - sTime;
+    const uint64_t eTime = timer.now();
+    std::chrono::duration<double, std::milli> fp_ms(timer.toMilliseconds(sTime, eTime));
 
     //end perf
     perfObject.stopCounters();
@@ -249,7 +251,8 @@ std::string LinkedListPerformanceTest(int size, int number, string function, str
     output += R"("nodeCount": )" + std::to_string(size) + ",";
     output += "\"type\": \"linked_list\",";
     output += R"("number": )" + std::to_string(number) + ",";
-    output += R"("algorithmRunTime_ms": )" + std::to_string(fp_ms.count());  
+    output += R"("algorithmRunTime_ms": )" + std::to_string(fp_ms.count()) + ",";
+    output += R"("algorithmTimer": ")" + timer.getClockName() + "\"";
 
     std::transform(perf.begin(), perf.end(), perf.begin(), ::tolower);
 
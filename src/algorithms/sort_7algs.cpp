@@ -11,9 +11,32 @@
 #include <iostream>
 #include <memory>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "Allocation.hpp"
+#include "Isolation.hpp"
+#include "JSONWriter.hpp"
+#include "ResultWriter.hpp"
 #include "RandomNum.hpp"
+#include "KeyTypes.hpp"
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+#include "Timer.hpp"
+#include "SortingNetworks.hpp"
 #include "../AlgoGaugeDetails.hpp"
 #include "../dependencies/PerfEvent.hpp"
 
@@ -37,7 +60,14 @@ namespace Sorting {
             "Repeated",
             "Chunks",
             "Sorted_Reversed",
-            "Sorted"
+            "Sorted",
+            "Zipf",
+            "Gaussian",
+            "Nearly_Sorted",
+            "Organ_Pipe",
+            "Sawtooth",
+            "Few_Unique",
+            "File"
     };
 
     /**
@@ -63,18 +93,28 @@ namespace Sorting {
             return this->canonicalName.empty() ? string("") : (string("<") + this->canonicalName + string("> "));
         }
         string getAlgorithmOption() { return AlgorithmOptionsStrings[algorithmOption]; }
-        T *getValuesPriorToSort() const { return this->valuesPriorToSort; }
+        T *getValuesPriorToSort() const { return this->valuesPriorToSort; } // nullptr unless the values are output or the sort is repeated
         T *returnValues() const { return this->arr; }
         string getStringResult();
         bool isVerbose() { return this->verbose; }
         bool valuesIncluded() { return this->verbose; }
+        unsigned int getThreadCount() const { return this->threadCount; }
+        string getKeyType() const { return KeyTypes::KeyTraits<T>::name; }
+        uint64_t getSeed() const { return this->seed; }
+        double getStrategyParameter() const { return this->strategyParameter; }
+        string getMemoryPolicy() const { return Allocation::PolicyStrings[memoryPolicyUsed]; } // the policy arr actually got
+        const std::vector<double> &getRunTimes() const { return this->runTimes; } // every timed run in milliseconds
         string getValuesRange();
-        string getJSONResult();
+        void writeJSONResult(Output::JSONWriter &writer);
+        Output::Row getResultRow();
 
         //setters
         void setCanonicalName(const string &c) { this->canonicalName = c; }
         void setVerbose(const bool &v = true) { this->verbose = v; }
         void setValuesIncluded(const bool &i = true) { this->verbose = i; }
+        void setSeed(const uint64_t &s, const RandomGenerator &g = philox) { this->seed = s; this->generator = g; }
+        void setMemoryPolicy(const Allocation::Policy &policy);
+        void setRepetitions(const unsigned int &repeat, const unsigned int &warmup = 0);
 
         //other class members
         void loadRandomValues();
@@ -82,6 +122,14 @@ namespace Sorting {
         void loadChunkValues();
         void loadReversedValues();
         void loadOrderedValues();
+        void loadZipfValues(double skew = 0);
+        void loadGaussianValues(double deviation = 0);
+        void loadNearlySortedValues(double percentPerturbed = 0);
+        void loadOrganPipeValues();
+        void loadSawtoothValues(double period = 0);
+        void loadFewUniqueValues(double cardinality = 0);
+        void loadFileValues(const string &filePath);
+        void loadCachedValues(const T *values, const AlgorithmOptions &option, const double &parameter, const string &filePath = "");
         void verifySort() const;
         void runAndCaptureSort();
         void runAndPrintSort(const bool& printToScreen);
@@ -100,13 +148,51 @@ namespace Sorting {
         bool includeValues;
         AlgoGauge::PERF includePerf;
         std::string perfObjectString = "{}";
+        std::vector<double> perfReport; // The same perf data as numbers, one per PerfEvent::getReportNames(). Empty without --perf
+        unsigned int threadCount{1}; // Number of threads the sort runs on. Parallel sorts overwrite this
+        uint64_t seed{0}; // The random values are generated from this, so the same seed gives the same values
+        RandomGenerator generator{philox};
+        double strategyParameter{0}; // The parameter the values were generated with. 0 for strategies that don't take one
+        string inputFile; // The file the values were loaded from, if any
+        Allocation::Policy memoryPolicy{Allocation::systemDefault}; // The policy every buffer is allocated with
+        Allocation::Policy memoryPolicyUsed{Allocation::systemDefault}; // What arr actually got, after any fallback
 
         virtual void runSort() = 0; // Pure virtual function.
+        virtual void allocateBuffers() {} // Sorts that need scratch space allocate it here, outside of the timed sort
+        T *allocateBuffer(unsigned int count);
+        void freeBuffer(T *buffer, unsigned int count);
         void printValues() const;
 
 
     private:
-        unsigned int *valuesPriorToSort; //Stores the values prior to sorting
+        template<typename Generate>
+        void fillValues(Generate generate);
+        template<typename Generate>
+        void generateValues(Generate generate);
+        void snapshotValues();
+        bool keepsSnapshot() const { return includeValues || warmups + repetitions > 1; }
+        static constexpr bool countOperations() { return KeyTypes::IsCounted<T>::value; }
+        static double median(const std::vector<double> &sortedTimes);
+
+        /**
+         * Summary of the timed runs, in milliseconds
+         */
+        struct RunTimeStats {
+            double min, median, mean, stddev, p95;
+        };
+        RunTimeStats getRunTimeStats() const;
+
+        unsigned int repetitions{1}; // The number of timed runs
+        unsigned int warmups{0}; // The number of untimed runs before the timed ones
+        std::vector<double> runTimes; // Milliseconds taken by every timed run, in the order they ran
+        string cpuGovernor; // The frequency scaling governor of the pinned CPUs. Empty when not pinned
+        double contextSwitches{-1}; // Over every timed run, when pinned. -1 if they couldn't be counted
+        double cpuMigrations{-1};
+        string profileString; // The hotspot tables from --profile. Empty when not profiled
+        KeyTypes::OperationCounts operationCounts; // Made by the median run. Only counted for KeyTypes::Counted elements
+        uint64_t scratchBytes{0}; // Allocated by allocateBuffers() before the runs. Only counted for KeyTypes::Counted elements
+        T *valuesPriorToSort{nullptr}; //Stores the values prior to sorting. Only allocated when they will be output or the sort is repeated
+        size_t mappedBytes{0}; // Not 0 when arr is a mapping of the input file rather than an allocated buffer
         std::chrono::duration<double, std::milli> executionTime;
         // void loadPerf();
     };
@@ -132,14 +218,17 @@ namespace Sorting {
         this->sortName = sortName;
         if (capacity > 0 && capacity < UINT32_MAX) this->capacity = capacity; //make sure capacity is more than 0 and less than an unsigned 32 bit int
         else throw std::invalid_argument("Length must be greater than 0 and less than " + std::to_string(UINT32_MAX));
-        this->arr = new T[capacity];
-        this->valuesPriorToSort = new T[capacity];
+        this->arr = allocateBuffer(capacity);
+        // the snapshot is only ever read to output the values or to restore them between repeated runs, so it isn't
+        // worth doubling the memory for otherwise. The values can always be regenerated from the seed instead
+        if (includeValues) this->valuesPriorToSort = allocateBuffer(capacity);
         this->canonicalName = canonicalName;
         this->algorithmOption = AlgorithmOptions::none;
         this->executionTime = (std::chrono::steady_clock::now() - std::chrono::steady_clock::now());
         this->verbose = verbose;
         this->includeValues = includeValues;
         this->includePerf = includePerf;
+        this->seed = RandomNum<>::newSeed();
         // this->loadPerf(); //initialize perf setup
     }
 
@@ -148,8 +237,126 @@ namespace Sorting {
      */
     template<typename T>
     BaseSort<T>::~BaseSort() {
-        delete[] arr;
-        delete[] valuesPriorToSort;
+#if !defined(_WIN32)
+        if (mappedBytes) munmap(arr, mappedBytes);
+        else freeBuffer(arr, capacity);
+#else
+        freeBuffer(arr, capacity);
+#endif
+        freeBuffer(valuesPriorToSort, capacity);
+    }
+
+    /**
+     * Allocates a buffer with the sort's memory policy (see setMemoryPolicy())
+     * @param count The number of values the buffer holds
+     * @return The buffer. Must be freed with freeBuffer()
+     */
+    template<typename T>
+    T *BaseSort<T>::allocateBuffer(unsigned int count) {
+        Allocation::Policy used;
+        if constexpr (KeyTypes::IsCounted<T>::value) KeyTypes::OperationCounter::local().bytesAllocated += size_t(count) * sizeof(T);
+        return static_cast<T *>(Allocation::allocate(size_t(count) * sizeof(T), memoryPolicy, used));
+    }
+
+    /**
+     * Frees a buffer from allocateBuffer()
+     * @param buffer The buffer. May be nullptr
+     * @param count The number of values it was allocated for
+     */
+    template<typename T>
+    void BaseSort<T>::freeBuffer(T *buffer, unsigned int count) {
+        Allocation::release(buffer, size_t(count) * sizeof(T), memoryPolicy);
+    }
+
+    /**
+     * Reallocates arr (and the snapshot) with a different memory policy. Scratch buffers are allocated with the same
+     * policy once the sort runs. Must be called before any values are loaded, as they are not kept
+     * @param policy The policy to allocate with. If the system can't give it, the closest policy it can is used, and
+     * getMemoryPolicy() says which one that was
+     */
+    template<typename T>
+    void BaseSort<T>::setMemoryPolicy(const Allocation::Policy &policy) {
+#if !defined(_WIN32)
+        if (mappedBytes) munmap(arr, mappedBytes);
+        else freeBuffer(arr, capacity);
+        mappedBytes = 0;
+#else
+        freeBuffer(arr, capacity);
+#endif
+        freeBuffer(valuesPriorToSort, capacity);
+        arr = valuesPriorToSort = nullptr;
+
+        memoryPolicy = policy;
+        arr = static_cast<T *>(Allocation::allocate(size_t(capacity) * sizeof(T), memoryPolicy, memoryPolicyUsed));
+        if (keepsSnapshot()) valuesPriorToSort = allocateBuffer(capacity);
+    }
+
+    /**
+     * Sets how many times runAndCaptureSort() sorts the values. Every run starts from the same values, and the
+     * warmup runs aren't timed. Must be called before any values are loaded, as repeating needs a copy of them
+     * @param repeat The number of timed runs. Must be at least 1
+     * @param warmup The number of untimed runs before the timed ones
+     */
+    template<typename T>
+    void BaseSort<T>::setRepetitions(const unsigned int &repeat, const unsigned int &warmup) {
+        if (repeat == 0) throw std::invalid_argument("A sort must be repeated at least once");
+        repetitions = repeat;
+        warmups = warmup;
+        if (keepsSnapshot() && valuesPriorToSort == nullptr) valuesPriorToSort = allocateBuffer(capacity);
+    }
+
+    /**
+     * Sets every value to generate(i), where i is the value's index. Large sets are cut into slices that are filled in
+     * parallel on every CPU the program may run on, so generate must only depend on i (and must be safe to call from
+     * any thread)
+     * @param generate Returns the value for an index
+     */
+    template<typename T>
+    template<typename Generate>
+    void BaseSort<T>::fillValues(Generate generate) {
+        auto fillSlice = [this, &generate](unsigned int first, unsigned int last) {
+            if (valuesPriorToSort) {
+                for (unsigned int i = first; i < last; i++) arr[i] = valuesPriorToSort[i] = generate(i); //We copy this so that we can have a history before sorting
+            } else {
+                for (unsigned int i = first; i < last; i++) arr[i] = generate(i);
+            }
+        };
+
+        const unsigned int minimumSliceSize = 1u << 16; // below this, starting a thread costs more than it saves
+        if (capacity <= minimumSliceSize || ThreadPool::resolveThreadCount(0) == 1) {
+            fillSlice(0, capacity);
+            return;
+        }
+
+        ThreadPool pool;
+        std::atomic<unsigned int> pending{0};
+        const unsigned int slices = std::min(pool.size() * 4, capacity / minimumSliceSize);
+        const unsigned int sliceSize = capacity / slices + 1;
+        for (unsigned int first = 0; first < capacity; first += sliceSize) {
+            const unsigned int last = std::min(capacity, first + sliceSize);
+            pool.submit([&fillSlice, first, last] { fillSlice(first, last); }, pending);
+        }
+        pool.wait(pending);
+    }
+
+    /**
+     * Like fillValues(), but generate is also handed 64 random bits for the index: generate(i, randomBits). With the
+     * Philox generator the bits are computed from the index, so the set is generated in parallel and is the same
+     * whatever the number of threads. Every other generator is sequential, so the set is filled in order on one thread
+     * @param generate Returns the value for an index and its random bits
+     */
+    template<typename T>
+    template<typename Generate>
+    void BaseSort<T>::generateValues(Generate generate) {
+        if (generator == philox) {
+            const Philox4x32 philoxEngine(seed);
+            fillValues([&philoxEngine, &generate](unsigned int i) { return generate(i, philoxEngine(i)); });
+            return;
+        }
+
+        RandomNum<uint64_t> distrib(0, UINT64_MAX, seed, generator);
+        for (unsigned int i = 0; i < capacity; ++i) arr[i] = generate(i, distrib.getRandomNumber());
+        snapshotValues();
     }
 
     /**
@@ -158,12 +365,10 @@ namespace Sorting {
     template<typename T>
     void BaseSort<T>::loadRandomValues() {
         algorithmOption = AlgorithmOptions::randomSet;
-        RandomNum distrib;
-
-        for (unsigned int i = 0; i < capacity; ++i) {
-            auto newRand = distrib.getRandomNumber();
-            arr[i] = valuesPriorToSort[i] = newRand; //We copy this so that we can have a history before sorting
-        }
+        const uint64_t range = KeyTypes::KeyTraits<T>::maxNumber + 1; // wraps to 0 (the whole range) for 64 bits
+        generateValues([range](unsigned int, uint64_t randomBits) {
+            return KeyTypes::KeyTraits<T>::fromNumber(scaleToRange(randomBits, range));
+        });
     }
 
     /**
@@ -172,14 +377,13 @@ namespace Sorting {
     template<typename T>
     void BaseSort<T>::loadRepeatedValues() {
         algorithmOption = AlgorithmOptions::repeatedSet;
-        RandomNum distrib;
-        auto randNum = distrib.getRandomNumber();
+        RandomNum<uint64_t> distrib(0, KeyTypes::KeyTraits<T>::maxNumber, seed, generator);
+        const T randNum = KeyTypes::KeyTraits<T>::fromNumber(distrib.getRandomNumber());
         //get random number to load in the repeated set. Honestly, it doesn't
         //really matter which specific number we use, we could have just used 0 or 1,
         //but it feels like this function needs a little extra seasoning to it.
 
-        for (unsigned int i = 0; i < capacity; i++)
-            arr[i] = valuesPriorToSort[i] = randNum; //We copy this so that we can have a history before sorting
+        fillValues([&randNum](unsigned int) { return randNum; });
     }
 
     /**
@@ -188,18 +392,110 @@ namespace Sorting {
     template<typename T>
     void BaseSort<T>::loadChunkValues() {
         algorithmOption = AlgorithmOptions::chunkSet;
-        RandomNum distrib;
-        unsigned int chunkSize = capacity < 10 ? 1 : 5;
-        bool flipFlop = RandomNum<>::randomBool(); // this is to prevent always choosing one subset first over the other
+        const unsigned int chunkSize = capacity < 10 ? 1 : 5;
+        if (generator == philox) {
+            // the chunk at index c is random when c's parity matches the first chunk's, and repeats the value at its
+            // first index otherwise. Stream 1 decides what the first chunk is
+            const Philox4x32 philoxEngine(seed);
+            const uint64_t range = KeyTypes::KeyTraits<T>::maxNumber + 1;
+            const bool firstChunkRandom = philoxEngine(0, 1) >> 63;
+            fillValues([&philoxEngine, range, chunkSize, firstChunkRandom](unsigned int i) {
+                unsigned int chunk = i / chunkSize;
+                bool chunkRandom = firstChunkRandom != bool(chunk & 1);
+                uint64_t counter = chunkRandom ? i : chunk * chunkSize;
+                return KeyTypes::KeyTraits<T>::fromNumber(scaleToRange(philoxEngine(counter), range));
+            });
+            return;
+        }
+
+        RandomNum<uint64_t> distrib(0, KeyTypes::KeyTraits<T>::maxNumber, seed, generator);
+        bool flipFlop = distrib.randomBool(); // this is to prevent always choosing one subset first over the other
         // e.g. if flipFlop was false first always, then the first set will always be repeated numbers
 
         for (unsigned int i = 0; i < capacity; flipFlop = !flipFlop) { //flip-flop the flipFlop
-            auto randNum = distrib.getRandomNumber();
+            T randNum = KeyTypes::KeyTraits<T>::fromNumber(distrib.getRandomNumber());
             for (int j = 0; j < chunkSize && i < capacity; j++, i++) {
-                if (flipFlop) randNum = distrib.getRandomNumber(); //choose a new random number if subset is on random mode
-                arr[i] = valuesPriorToSort[i] = randNum;
+                if (flipFlop) randNum = KeyTypes::KeyTraits<T>::fromNumber(distrib.getRandomNumber()); //choose a new random number if subset is on random mode
+                arr[i] = randNum;
             }
         }
+        snapshotValues();
+    }
+
+    /**
+     * This loads the first capacity values from a binary file of raw keys, stored back to back in the machine's byte
+     * order (little-endian on x86 and ARM). The file is mapped copy-on-write in place of arr, so nothing is parsed,
+     * there is no second copy in memory, and the file itself is never changed. Every page is written once before
+     * returning so the copy-on-write faults happen here instead of being timed as part of the sort. Systems without
+     * mmap read the file into arr instead
+     * @param filePath The file to load
+     */
+    template<typename T>
+    void BaseSort<T>::loadFileValues(const string &filePath) {
+        algorithmOption = AlgorithmOptions::fileSet;
+        inputFile = filePath;
+        const size_t bytes = size_t(capacity) * sizeof(T);
+
+#if !defined(_WIN32)
+        int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+        if (fileDescriptor < 0) throw std::invalid_argument("Could not open the input file: " + filePath);
+        struct stat fileStats{};
+        if (fstat(fileDescriptor, &fileStats) != 0 || size_t(fileStats.st_size) < bytes) {
+            close(fileDescriptor);
+            throw std::invalid_argument("The input file " + filePath + " holds fewer than " + std::to_string(capacity)
+                                        + " values of " + std::to_string(sizeof(T)) + " bytes");
+        }
+
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE; // read the whole file in now, rather than on first touch during the sort
+#endif
+        void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fileDescriptor, 0);
+        close(fileDescriptor); // the mapping keeps its own reference to the file
+        if (mapping == MAP_FAILED) throw std::runtime_error("Could not map the input file: " + filePath);
+
+        if (mappedBytes) munmap(arr, mappedBytes);
+        else freeBuffer(arr, capacity);
+        arr = static_cast<T *>(mapping);
+        mappedBytes = bytes;
+        memoryPolicyUsed = Allocation::systemDefault; // the file's pages come from the page cache, whatever the policy
+
+        const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+        auto *pages = static_cast<volatile unsigned char *>(mapping);
+        for (size_t offset = 0; offset < bytes; offset += pageSize) pages[offset] = pages[offset];
+#else
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file) throw std::invalid_argument("Could not open the input file: " + filePath);
+        if (!file.read(reinterpret_cast<char *>(arr), std::streamsize(bytes))) {
+            throw std::invalid_argument("The input file " + filePath + " holds fewer than " + std::to_string(capacity)
+                                        + " values of " + std::to_string(sizeof(T)) + " bytes");
+        }
+#endif
+        snapshotValues();
+    }
+
+    /**
+     * This loads a copy of values that were already generated (or loaded) by another sort, and records the strategy
+     * they were made with. Used to share one dataset between every algorithm in a batch
+     * @param values The values to copy. Must hold capacity values
+     * @param option The strategy the values were made with
+     * @param parameter The strategy parameter the values were made with
+     * @param filePath The file the values were loaded from, for the file strategy
+     */
+    template<typename T>
+    void BaseSort<T>::loadCachedValues(const T *values, const AlgorithmOptions &option, const double &parameter, const string &filePath) {
+        algorithmOption = option;
+        strategyParameter = parameter;
+        inputFile = filePath;
+        fillValues([values](unsigned int i) { return values[i]; });
+    }
+
+    /**
+     * Copies the loaded values into valuesPriorToSort (if it was allocated) so that we can have a history before sorting
+     */
+    template<typename T>
+    void BaseSort<T>::snapshotValues() {
+        if (valuesPriorToSort) std::copy(arr, arr + capacity, valuesPriorToSort);
     }
 
     /**
@@ -258,7 +554,7 @@ namespace Sorting {
     template<typename T>
     void BaseSort<T>::loadReversedValues() {
         algorithmOption = AlgorithmOptions::reversedSet;
-        for (unsigned int i = capacity; i > 0; i--) arr[i - 1] = valuesPriorToSort[i - 1] = i - 1;
+        fillValues([](unsigned int i) { return KeyTypes::KeyTraits<T>::fromNumber(i); });
     }
 
     /**
@@ -267,7 +563,116 @@ namespace Sorting {
     template<typename T>
     void BaseSort<T>::loadOrderedValues() {
         algorithmOption = AlgorithmOptions::sortedSet;
-        for (unsigned int i = 0; i < capacity; i++) arr[i] = valuesPriorToSort[i] = i;
+        fillValues([](unsigned int i) { return KeyTypes::KeyTraits<T>::fromNumber(i); });
+    }
+
+    /**
+     * This loads values following (approximately) a Zipf distribution: the k-th smallest of capacity possible values
+     * turns up in proportion to 1/k^skew, so a few small values repeat a lot and there is a long tail of rare ones. Ranks
+     * are drawn by inverting the CDF of the continuous power law, which needs no table and no rejection
+     * @param skew The Zipf exponent. 0 uses 1.0
+     */
+    template<typename T>
+    void BaseSort<T>::loadZipfValues(double skew) {
+        algorithmOption = AlgorithmOptions::zipfSet;
+        if (skew < 0) throw std::invalid_argument("The Zipf skew can not be negative");
+        strategyParameter = skew = skew == 0 ? 1.0 : skew;
+
+        const double ranks = capacity;
+        const double exponent = 1.0 - skew;
+        const double span = std::fabs(exponent) < 1e-9 ? std::log(ranks + 1.0) : std::pow(ranks + 1.0, exponent) - 1.0;
+        generateValues([ranks, exponent, span](unsigned int, uint64_t randomBits) {
+            const double uniform = (randomBits >> 11) * 0x1.0p-53; // [0, 1)
+            double x = std::fabs(exponent) < 1e-9 ? std::exp(uniform * span) : std::pow(uniform * span + 1.0, 1.0 / exponent);
+            double rank = std::min(std::floor(x) - 1.0, ranks - 1.0);
+            return KeyTypes::KeyTraits<T>::fromNumber(rank > 0 ? uint64_t(rank) : 0);
+        });
+    }
+
+    /**
+     * This loads normally distributed values centered in the middle of the value range, cut off at both ends of it
+     * @param deviation The standard deviation as a fraction of the value range. 0 uses 0.1
+     */
+    template<typename T>
+    void BaseSort<T>::loadGaussianValues(double deviation) {
+        algorithmOption = AlgorithmOptions::gaussianSet;
+        if (deviation < 0) throw std::invalid_argument("The Gaussian standard deviation can not be negative");
+        strategyParameter = deviation = deviation == 0 ? 0.1 : deviation;
+
+        const double maxNumber = double(KeyTypes::KeyTraits<T>::maxNumber);
+        const double mean = maxNumber / 2;
+        const double standardDeviation = deviation * maxNumber;
+        generateValues([maxNumber, mean, standardDeviation](unsigned int, uint64_t randomBits) {
+            // Box-Muller, with the two uniforms taken from the two halves of the random bits
+            const double uniform1 = ((randomBits >> 32) + 1.0) * 0x1.0p-32; // (0, 1], so the log is finite
+            const double uniform2 = (randomBits & 0xFFFFFFFFu) * 0x1.0p-32;
+            const double value = mean + standardDeviation * std::sqrt(-2.0 * std::log(uniform1)) * std::cos(2.0 * 3.14159265358979323846 * uniform2);
+            if (value <= 0) return KeyTypes::KeyTraits<T>::fromNumber(0);
+            if (value >= maxNumber) return KeyTypes::KeyTraits<T>::fromNumber(KeyTypes::KeyTraits<T>::maxNumber);
+            return KeyTypes::KeyTraits<T>::fromNumber(uint64_t(value));
+        });
+    }
+
+    /**
+     * This loads values that are sorted in order except for a percentage of them, which are replaced with random
+     * values from anywhere in the set
+     * @param percentPerturbed How many of the values (0 to 100) are out of place. 0 uses 5
+     */
+    template<typename T>
+    void BaseSort<T>::loadNearlySortedValues(double percentPerturbed) {
+        algorithmOption = AlgorithmOptions::nearlySortedSet;
+        if (percentPerturbed < 0 || percentPerturbed > 100) throw std::invalid_argument("The percent of perturbed values must be between 0 and 100");
+        strategyParameter = percentPerturbed = percentPerturbed == 0 ? 5 : percentPerturbed;
+
+        // compared against the top 32 random bits, which leaves the bottom 32 for picking the replacement value
+        const uint64_t threshold = uint64_t(percentPerturbed / 100.0 * 4294967296.0);
+        const uint64_t range = capacity;
+        generateValues([threshold, range](unsigned int i, uint64_t randomBits) {
+            if ((randomBits >> 32) < threshold) return KeyTypes::KeyTraits<T>::fromNumber(scaleToRange(randomBits << 32, range));
+            return KeyTypes::KeyTraits<T>::fromNumber(i);
+        });
+    }
+
+    /**
+     * This loads values that go up to the middle of the set and back down again (0, 1, 2, ..., 2, 1, 0)
+     */
+    template<typename T>
+    void BaseSort<T>::loadOrganPipeValues() {
+        algorithmOption = AlgorithmOptions::organPipeSet;
+        const unsigned int last = capacity - 1;
+        fillValues([last](unsigned int i) { return KeyTypes::KeyTraits<T>::fromNumber(std::min(i, last - i)); });
+    }
+
+    /**
+     * This loads runs of values counting up from 0 that start over every period values (0, 1, 2, 0, 1, 2, ...)
+     * @param period The length of each run. 0 makes 16 runs
+     */
+    template<typename T>
+    void BaseSort<T>::loadSawtoothValues(double period) {
+        algorithmOption = AlgorithmOptions::sawtoothSet;
+        if (period < 0) throw std::invalid_argument("The sawtooth period can not be negative");
+        unsigned int runLength = period == 0 ? (capacity + 15) / 16 : static_cast<unsigned int>(std::min(period, double(capacity)));
+        if (runLength == 0) runLength = 1;
+        strategyParameter = runLength;
+
+        fillValues([runLength](unsigned int i) { return KeyTypes::KeyTraits<T>::fromNumber(i % runLength); });
+    }
+
+    /**
+     * This loads values picked at random from a small number of distinct values, spread evenly over the value range
+     * @param cardinality How many distinct values there are. 0 uses 16
+     */
+    template<typename T>
+    void BaseSort<T>::loadFewUniqueValues(double cardinality) {
+        algorithmOption = AlgorithmOptions::fewUniqueSet;
+        if (cardinality < 0) throw std::invalid_argument("The number of unique values can not be negative");
+        const uint64_t distinctValues = cardinality == 0 ? 16 : std::max(uint64_t(1), uint64_t(cardinality));
+        strategyParameter = double(distinctValues);
+
+        const uint64_t spacing = std::max(uint64_t(1), KeyTypes::KeyTraits<T>::maxNumber / distinctValues);
+        generateValues([distinctValues, spacing](unsigned int, uint64_t randomBits) {
+            return KeyTypes::KeyTraits<T>::fromNumber(scaleToRange(randomBits, distinctValues) * spacing);
+        });
     }
 
     /**
@@ -289,32 +694,110 @@ namespace Sorting {
     void BaseSort<T>::runAndCaptureSort() {
 
 
-        PerfEvent perfObject;
+        const bool countPerf = includePerf == perfON || includePerf == perfGrouped;
+        PerfEvent perfObject(0, includePerf == perfGrouped);
+        if (includePerf == perfGrouped && perfObject.getGroupCount() > repetitions) {
+            std::cerr << "Only " << repetitions << " of the " << perfObject.getGroupCount()
+                      << " perf counter groups will be measured. Use --repeat " << perfObject.getGroupCount()
+                      << " or more to measure them all" << std::endl;
+        }
         if (verbose) cout << "C++ Starting sort: \"" << sortName << "\"" << getCanonicalName() << "..." << endl;
-        
-        auto startTime = std::chrono::steady_clock::now(); //record the start time counter
-
-        if (includePerf == perfON){
-            if(verbose) std::cout << "Starting PERF" << std::endl;
-            perfObject.startCounters();
+        const KeyTypes::OperationCounts countsBeforeBuffers = countOperations() ? KeyTypes::OperationCounter::total() : KeyTypes::OperationCounts();
+        allocateBuffers();
+        if (countOperations()) scratchBytes = (KeyTypes::OperationCounter::total() - countsBeforeBuffers).bytesAllocated;
+
+        // pinned again and the governors checked before every sort, as either can change while the program runs
+        Isolation::Isolator &isolator = Isolation::Isolator::global();
+        std::unique_ptr<PerfEvent> schedulerEvents;
+        cpuGovernor.clear();
+        if (isolator.isActive()) {
+            isolator.pin();
+            cpuGovernor = isolator.checkGovernors();
+            schedulerEvents.reset(new PerfEvent(PerfEvent::SchedulerCounters{}));
         }
+        contextSwitches = cpuMigrations = schedulerEvents ? 0 : -1;
+
+        // opened before the runs, as it reads the ring buffers on a thread of its own
+        std::unique_ptr<Profiling::Sampler> sampler;
+        if (Profiling::settings().enabled) sampler.reset(new Profiling::Sampler(Profiling::settings().frequency));
+
+        runTimes.clear();
+        std::vector<string> perfStrings; // one per timed run, so the median run's counters can be reported
+        std::vector<std::vector<double>> perfReports; // and the same counters as numbers, for the tables
+        std::vector<KeyTypes::OperationCounts> runCounts; // likewise for the operation counts
+        for (unsigned int run = 0; run < warmups + repetitions; run++) {
+            const bool timed = run >= warmups;
+            // every run sorts the same values as the first. Restoring them isn't timed
+            if (run > 0) std::copy(valuesPriorToSort, valuesPriorToSort + capacity, arr);
+            if (verbose && warmups + repetitions > 1) {
+                cout << "C++ " << (timed ? "Run " : "Warmup run ") << (timed ? run - warmups : run) + 1 << " of "
+                     << (timed ? repetitions : warmups) << endl;
+            }
 
-        runSort();
+            // perf is started before and stopped after the clock is read, so its system calls (and the verbose
+            // prints) aren't timed as part of the sort
+            if (countPerf && timed){
+                if(verbose) std::cout << "Starting PERF" << std::endl;
+                perfObject.startCounters();
+            }
+            if (schedulerEvents && timed) schedulerEvents->startCounters();
+            if (sampler && timed) sampler->start();
+
+            const KeyTypes::OperationCounts countsBefore = countOperations() ? KeyTypes::OperationCounter::total() : KeyTypes::OperationCounts();
+            const Timing::Timer &timer = Timing::Timer::global();
+            const uint64_t startTime = timer.now(); //record the start time counter
+            runSort();
+            const uint64_t stopTime = timer.now(); //record the stop time counter
+            if (countOperations() && timed) runCounts.push_back(KeyTypes::OperationCounter::total() - countsBefore);
+            if (sampler && timed) sampler->stop();
+
+            if (schedulerEvents && timed) {
+                schedulerEvents->stopCounters();
+                const double switches = schedulerEvents->getCounter("context switches");
+                const double migrations = schedulerEvents->getCounter("CPU Migrations");
+                // -1 once either couldn't be counted, rather than a total missing some runs
+                contextSwitches = switches < 0 || contextSwitches < 0 ? -1 : contextSwitches + switches;
+                cpuMigrations = migrations < 0 || cpuMigrations < 0 ? -1 : cpuMigrations + migrations;
+            }
 
-        if (includePerf == perfON){
-            perfObject.stopCounters();
-            if(verbose) std::cout << "Stopping PERF it ran for: " << perfObject.getDuration() << std::endl;
-        }
-        auto stopTime = std::chrono::steady_clock::now(); //record the stop time counter
+            if (countPerf && timed){
+                perfObject.stopCounters();
+                if(verbose) std::cout << "Stopping PERF it ran for: " << perfObject.getDuration() << std::endl;
+            }
 
-        if (verbose) cout << "C++ Verifying sort: \"" << sortName << "\"" << getCanonicalName() << "..." << endl;
+            if (verbose) cout << "C++ Verifying sort: \"" << sortName << "\"" << getCanonicalName() << "..." << endl;
 
-        verifySort();
+            verifySort();
 
-        if (verbose) cout << "C++ Sort: \"" << sortName << "\"" << getCanonicalName() << " Verified!" << endl;
-        executionTime = stopTime - startTime;
+            if (verbose) cout << "C++ Sort: \"" << sortName << "\"" << getCanonicalName() << " Verified!" << endl;
+            if (!timed) continue;
+            runTimes.push_back(timer.toMilliseconds(startTime, stopTime));
+            if (includePerf == perfON) {
+                perfStrings.push_back(perfObject.getPerfJSONString());
+                perfReports.push_back(perfObject.getReport());
+            }
+        }
 
-        if (includePerf == perfON) this->perfObjectString = perfObject.getPerfJSONString();
+        // symbolized after the runs, so reading the symbols isn't timed
+        profileString = sampler ? sampler->getJSONString() : "";
+
+        // the median is reported as the run time, since one run slowed down by the rest of the machine can't move it
+        std::vector<double> sortedTimes(runTimes);
+        std::sort(sortedTimes.begin(), sortedTimes.end());
+        executionTime = std::chrono::duration<double, std::milli>(median(sortedTimes));
+
+        const double medianRun = sortedTimes[(sortedTimes.size() - 1) / 2];
+        const size_t medianIndex = std::find(runTimes.begin(), runTimes.end(), medianRun) - runTimes.begin();
+        if (countOperations()) operationCounts = runCounts[medianIndex];
+
+        // grouped counters are averaged over every run, as each run only measures some of them
+        if (includePerf == perfGrouped) {
+            this->perfObjectString = perfObject.getPerfJSONString();
+            this->perfReport = perfObject.getReport();
+        } else if (includePerf == perfON) {
+            this->perfObjectString = perfStrings[medianIndex];
+            this->perfReport = perfReports[medianIndex];
+        }
 
         if(includePerf == sample){
             if(verbose) std::cout << "Sample PERF Data Insert" << std::endl;
@@ -340,6 +823,17 @@ namespace Sorting {
 // #endif
     }
 
+    /**
+     * @param sortedTimes Run times in ascending order. Must not be empty
+     * @return The middle run time, or the mean of the middle two for an even number of runs
+     */
+    template<typename T>
+    double BaseSort<T>::median(const std::vector<double> &sortedTimes) {
+        const size_t middle = sortedTimes.size() / 2;
+        if (sortedTimes.size() % 2 == 1) return sortedTimes[middle];
+        return (sortedTimes[middle - 1] + sortedTimes[middle]) / 2;
+    }
+
     /**
      * Returns the result of the sort in string format
      * @return The result of the sort in string format
@@ -368,6 +862,7 @@ namespace Sorting {
                + string(", completed in ")
                + std::to_string(executionTime.count())
                + string(" milliseconds")
+               + (repetitions > 1 ? string(" (median of ") + std::to_string(repetitions) + string(" runs)") : string(""))
                + perfString;
     }
 
@@ -379,17 +874,17 @@ namespace Sorting {
     template<typename T>
     string BaseSort<T>::getValuesRange() {
         string returnString;
-        returnString = std::to_string(arr[0]);
+        returnString = KeyTypes::KeyTraits<T>::toString(arr[0]);
         // store the first 25 values only
         for (unsigned int i = 1; i < (capacity < 25 ? capacity : 25); i++) {
-            returnString += ", " + std::to_string(arr[i]);
+            returnString += ", " + KeyTypes::KeyTraits<T>::toString(arr[i]);
         }
 
         //if capacity is more than 25, store up to the last 25
         if (capacity > 25) {
             returnString += " ... ";
             for (unsigned int i = (capacity - 25 > 0 ? capacity - 25 : 25); i < capacity; i++) {
-                returnString += ", " + std::to_string(arr[i]);
+                returnString += ", " + KeyTypes::KeyTraits<T>::toString(arr[i]);
             }
         }
         return returnString;
@@ -404,42 +899,155 @@ namespace Sorting {
     }
 
     /**
-     * Gets the result of a sort in JSON format
-     * @return A string object containing the results of a sort in JSON format
+     * Writes the result of a sort in JSON format, straight to wherever the writer writes. The values are formatted
+     * one at a time, so no string ever holds the whole array
+     * @param writer Where to write the result object
      */
     template<typename T>
-    string BaseSort<T>::getJSONResult() {
-        string output = "{";
-        output += R"("algorithmName": ")" + sortName + "\",";
-        output += R"("algorithmOption": ")" + getAlgorithmOption() + "\",";
-        output += R"("algorithmLength": )" + std::to_string(capacity) + ",";
-        output += R"("language": "C++",)";
-        output += R"("algorithmCanonicalName": ")" + canonicalName + "\",";
-
+    void BaseSort<T>::writeJSONResult(Output::JSONWriter &writer) {
+        writer.beginObject();
+        writer.key("algorithmName").value(sortName);
+        writer.key("algorithmOption").value(getAlgorithmOption());
+        writer.key("algorithmLength").value(capacity);
+        std::ostringstream parameter;
+        parameter << strategyParameter;
+        writer.key("algorithmOptionParameter").raw(parameter.str());
+        writer.key("algorithmInputFile").value(inputFile);
+        writer.key("language").value("C++");
+        writer.key("algorithmCanonicalName").value(canonicalName);
+        writer.key("algorithmThreads").value(threadCount);
+        writer.key("algorithmKeyType").value(getKeyType());
+        writer.key("algorithmElementBytes").value(sizeof(T));
+        writer.key("algorithmSeed").value(std::to_string(seed)); // a string, as JSON numbers lose precision past 2^53
+        writer.key("algorithmGenerator").value(RandomGeneratorStrings[generator]);
+        writer.key("algorithmMemoryPolicy").value(getMemoryPolicy());
+        writer.key("algorithmTimer").value(Timing::Timer::global().getClockName());
+        if (!cpuGovernor.empty()) {
+            writer.key("algorithmCpus").value(Isolation::Isolator::global().getCpuList());
+            writer.key("algorithmCpuGovernor").value(cpuGovernor);
+            // totals over the timed runs. null when the kernel wouldn't count them
+            if (contextSwitches < 0) writer.key("algorithmContextSwitches").value(nullptr);
+            else writer.key("algorithmContextSwitches").value(uint64_t(contextSwitches));
+            if (cpuMigrations < 0) writer.key("algorithmCpuMigrations").value(nullptr);
+            else writer.key("algorithmCpuMigrations").value(uint64_t(cpuMigrations));
+        }
 
         if (includeValues) {
-            output += R"("valuesBeforeSort": [)";
-            for (unsigned int i = 0; i < capacity; i++) {
-                output += std::to_string(valuesPriorToSort[i]) + ",";
-            }
+            writer.key("valuesBeforeSort").beginArray();
+            for (unsigned int i = 0; i < capacity; i++) writer.element(valuesPriorToSort[i]);
+            writer.endArray();
+            writer.key("valuesAfterSort").beginArray();
+            for (unsigned int i = 0; i < capacity; i++) writer.element(arr[i]);
+            writer.endArray();
+        }
 
-            output.pop_back(); //remove extraneous commas
-            output += R"(],"valuesAfterSort": [)";
+        writer.key("algorithmRunTime_ms").value(executionTime.count()); // the median run
+        if (countOperations()) {
+            writer.key("algorithmOperationCounts").beginObject();
+            writer.key("comparisons").value(operationCounts.comparisons);
+            writer.key("swaps").value(operationCounts.swaps);
+            writer.key("moves").value(operationCounts.moves);
+            writer.key("bytesAllocated").value(operationCounts.bytesAllocated);
+            writer.key("scratchBytes").value(scratchBytes);
+            writer.endObject();
+        }
+        writer.key("algorithmRepetitions").value(repetitions);
+        writer.key("algorithmWarmups").value(warmups);
+
+        if (!runTimes.empty()) {
+            const RunTimeStats stats = getRunTimeStats();
+            writer.key("algorithmRunTimeStats_ms").beginObject();
+            writer.key("min").value(stats.min);
+            writer.key("median").value(stats.median);
+            writer.key("mean").value(stats.mean);
+            writer.key("stddev").value(stats.stddev);
+            writer.key("p95").value(stats.p95);
+            writer.endObject();
+
+            writer.key("algorithmRunTimeSamples_ms").beginArray();
+            for (double time : runTimes) writer.value(time);
+            writer.endArray();
+        }
 
-            for (unsigned int i = 0; i < capacity; i++) {
-                output += std::to_string(arr[i]) + ",";
-            }
+        if (!profileString.empty()) writer.key("algorithmProfile").raw(profileString);
+        //always return the perf data object regardless. If no perf data, perf object will just be empty
+        writer.key("perfData").raw(perfObjectString);
+        writer.endObject();
+    }
 
-            output.pop_back(); //remove extraneous commas
-            output += "],";
+    /**
+     * Gets the result of a sort as a row of the results table (--format csv or columnar). It has the same names as
+     * the JSON, with the members of nested objects named object.member, and every perf counter as its own column.
+     * Every sort has the same columns, with null for the ones it doesn't have. The values and the run time samples
+     * aren't single values, so they are only in the JSON
+     * @return The row
+     */
+    template<typename T>
+    Output::Row BaseSort<T>::getResultRow() {
+        Output::Row row;
+        row.setText("algorithmName", sortName);
+        row.setText("algorithmOption", getAlgorithmOption());
+        row.setNumber("algorithmLength", capacity);
+        row.setReal("algorithmOptionParameter", strategyParameter);
+        row.setText("algorithmInputFile", inputFile);
+        row.setText("language", "C++");
+        row.setText("algorithmCanonicalName", canonicalName);
+        row.setNumber("algorithmThreads", threadCount);
+        row.setText("algorithmKeyType", getKeyType());
+        row.setNumber("algorithmElementBytes", sizeof(T));
+        row.setNumber("algorithmSeed", seed);
+        row.setText("algorithmGenerator", RandomGeneratorStrings[generator]);
+        row.setText("algorithmMemoryPolicy", getMemoryPolicy());
+        row.setText("algorithmTimer", Timing::Timer::global().getClockName());
+        if (!cpuGovernor.empty()) {
+            row.setText("algorithmCpus", Isolation::Isolator::global().getCpuList());
+            row.setText("algorithmCpuGovernor", cpuGovernor);
         }
+        if (contextSwitches >= 0) row.setNumber("algorithmContextSwitches", uint64_t(contextSwitches));
+        if (cpuMigrations >= 0) row.setNumber("algorithmCpuMigrations", uint64_t(cpuMigrations));
+
+        row.setReal("algorithmRunTime_ms", executionTime.count());
+        if (countOperations()) {
+            const string counts = "algorithmOperationCounts.";
+            row.setNumber(counts + "comparisons", operationCounts.comparisons);
+            row.setNumber(counts + "swaps", operationCounts.swaps);
+            row.setNumber(counts + "moves", operationCounts.moves);
+            row.setNumber(counts + "bytesAllocated", operationCounts.bytesAllocated);
+            row.setNumber(counts + "scratchBytes", scratchBytes);
+        }
+        row.setNumber("algorithmRepetitions", repetitions);
+        row.setNumber("algorithmWarmups", warmups);
+
+        const RunTimeStats stats = getRunTimeStats();
+        row.setReal("algorithmRunTimeStats_ms.min", stats.min);
+        row.setReal("algorithmRunTimeStats_ms.median", stats.median);
+        row.setReal("algorithmRunTimeStats_ms.mean", stats.mean);
+        row.setReal("algorithmRunTimeStats_ms.stddev", stats.stddev);
+        row.setReal("algorithmRunTimeStats_ms.p95", stats.p95);
+
+        const std::vector<std::string> perfNames = PerfEvent::getReportNames();
+        for (size_t i = 0; i < perfReport.size() && i < perfNames.size(); i++) row.setReal("perfData." + perfNames[i], perfReport[i]);
+        return row;
+    }
 
-        output += "\"algorithmRunTime_ms\": " + std::to_string(executionTime.count());
-
-        output += ", \"perfData\": "; //always return the perf data object regardless. If no perf data, perf object will just be empty
-        output += perfObjectString;
-            
-        return output + "}";
+    /**
+     * @return The min, median, mean, standard deviation and 95th percentile of the timed runs. NaN before any ran
+     */
+    template<typename T>
+    typename BaseSort<T>::RunTimeStats BaseSort<T>::getRunTimeStats() const {
+        if (runTimes.empty()) return {NAN, NAN, NAN, NAN, NAN};
+        std::vector<double> sortedTimes(runTimes);
+        std::sort(sortedTimes.begin(), sortedTimes.end());
+        double mean = 0;
+        for (double time : runTimes) mean += time;
+        mean /= double(runTimes.size());
+        double squaredDeviations = 0;
+        for (double time : runTimes) squaredDeviations += (time - mean) * (time - mean);
+        // the sample standard deviation, since the runs are a sample of how long the sort can take
+        const double deviation = runTimes.size() > 1 ? std::sqrt(squaredDeviations / double(runTimes.size() - 1)) : 0;
+        // nearest rank, so the 95th percentile is always a time that was actually measured
+        const size_t rank95 = size_t(std::ceil(0.95 * double(sortedTimes.size())));
+        return {sortedTimes.front(), median(sortedTimes), mean, deviation, sortedTimes[rank95 - 1]};
     }
 
     /**
@@ -493,10 +1101,7 @@ void Bubble<T>::runSort() {
 
         for (unsigned int i = 0; i < n - 1; i++) {
             if (this->arr[i] > this->arr[i + 1]) {
-                // Swap using a temporary variable
-                T temp = this->arr[i];
-                this->arr[i] = this->arr[i + 1];
-                this->arr[i + 1] = temp;
+                KeyTypes::swapValues(this->arr[i], this->arr[i + 1]);
                 swapped = true;
                 lastUnsorted = i + 1; // Update last unsorted position
             }
@@ -540,9 +1145,7 @@ void Bubble<T>::runSort() {
             for (unsigned int j = i + 1; j < this->capacity; j++) {
                 // We have an i (the index we hope to sort) and a j (a candidate to check)
                 if (this->arr[j] < this->arr[i]) {
-                    T temp = this->arr[i];
-                    this->arr[i] = this->arr[j];
-                    this->arr[j] = temp;
+                    KeyTypes::swapValues(this->arr[i], this->arr[j]);
                 }
             }
         }
@@ -580,9 +1183,7 @@ void Bubble<T>::runSort() {
             // no swaps are needed, or until we get to index 0.
             unsigned int j = i;
             while (j > 0 && this->arr[j] < this->arr[j - 1]) {
-                T temp = this->arr[j];
-                this->arr[j] = this->arr[j - 1];
-                this->arr[j - 1] = temp;
+                KeyTypes::swapValues(this->arr[j], this->arr[j - 1]);
                 j--;
             }
         }
@@ -604,7 +1205,17 @@ void Bubble<T>::runSort() {
 
         void runSort();
 
-    private:
+    protected:
+        // Used by variants of quick sort that reuse the partitioning and recursion logic
+        Quick(
+                const string &sortName,
+                const unsigned int capacity,
+                const string &canonicalName,
+                const bool &verbose,
+                const bool &includedValues,
+                const AlgoGauge::PERF& includePerf
+        ) : BaseSort<T>(sortName, capacity, canonicalName, verbose, includedValues, includePerf) {};
+
         void runSort(unsigned int first, unsigned int last);
 
         unsigned int quickSortPartition(unsigned int first, unsigned int last);
@@ -641,139 +1252,628 @@ void Bubble<T>::runSort() {
         T pivot;
         unsigned int index;
         unsigned int smallIndex;
-        T temp;
         pivot = this->arr[first];
         smallIndex = first;
         for (index = first + 1; index < last; index++) {
             if (this->arr[index] < pivot) {
                 smallIndex++;
-                //swap
-                temp = this->arr[smallIndex];
-                this->arr[smallIndex] = this->arr[index];
-                this->arr[index] = temp;
+                KeyTypes::swapValues(this->arr[smallIndex], this->arr[index]);
             }
         }
         // swap pivot into its final spot
-        temp = this->arr[first];
-        this->arr[first] = this->arr[smallIndex];
-        this->arr[smallIndex] = temp;
+        KeyTypes::swapValues(this->arr[first], this->arr[smallIndex]);
 
         return smallIndex;
     }
 
     /**
-     * This is the class for handling the Heap Sort Algorithm.
+     * This is the class for handling the Intro Sort Algorithm. It is a quick sort that can't go quadratic: the pivot
+     * is a median of 3 (or a ninther for large ranges), keys equal to the pivot are split evenly between both sides,
+     * ranges that recurse too deep fall back to heap sort, and small ranges are finished with insertion sort.
      */
     template<typename T>
-    class Heap : public BaseSort<T> {
+    class Intro : public BaseSort<T> {
     public:
-        Heap(
+        Intro(
                 const unsigned int capacity,
                 const string &canonicalName = "",
                 const bool &verbose = false,
                 const bool &includedValues = false,
                 const AlgoGauge::PERF& includePerf = perfOFF
-        ) : BaseSort<T>("Heap", capacity, canonicalName, verbose, includedValues, includePerf) {};
+        ) : BaseSort<T>("Intro", capacity, canonicalName, verbose, includedValues, includePerf) {};
 
         void runSort();
 
-    private:
-        void heapify(unsigned int lastUnsortedIndex, unsigned int parent);
+    protected:
+        // Used by variants of intro sort that only change how a range is partitioned
+        Intro(
+                const string &sortName,
+                const unsigned int capacity,
+                const string &canonicalName,
+                const bool &verbose,
+                const bool &includedValues,
+                const AlgoGauge::PERF& includePerf
+        ) : BaseSort<T>(sortName, capacity, canonicalName, verbose, includedValues, includePerf) {};
+
+        void runSort(unsigned int first, unsigned int last, unsigned int depthLimit);
+
+        virtual unsigned int partition(unsigned int first, unsigned int last);
+        void movePivotToFirst(unsigned int first, unsigned int last);
+        unsigned int medianOfThree(unsigned int a, unsigned int b, unsigned int c) const;
+        virtual void sortSmallRange(unsigned int first, unsigned int last) { insertionSort(first, last); }
+        void insertionSort(unsigned int first, unsigned int last);
+        void heapSort(unsigned int first, unsigned int last);
+        void siftDown(unsigned int first, unsigned int size, unsigned int parent);
+
+        unsigned int smallRangeCutoff{16}; // Ranges at or below this size are handed to sortSmallRange()
+        static constexpr unsigned int nintherCutoff = 128;
     };
 
+    /**
+     * This is the starter function for the intro sort algorithm. The depth limit is 2 * log2(n), past which quick sort
+     * is clearly not splitting the range well.
+     * @IMPORTANT Only run this function as it starts the other is a recursive function
+     */
     template<typename T>
-    void Heap<T>::heapify(unsigned int lastUnsortedIndex, unsigned int parent) {
-        // Find largest among root, left child and right child
-        unsigned int largest = parent;
-        unsigned int left = 2 * parent + 1;
-        unsigned int right = 2 * parent + 2;
+    void Intro<T>::runSort() {
+        unsigned int depthLimit = 0;
+        for (unsigned int n = this->capacity; n > 1; n >>= 1) depthLimit += 2;
+        runSort(0, this->capacity, depthLimit);
+    }
 
-        if (left < lastUnsortedIndex && this->arr[left] > this->arr[largest])
-            largest = left;
+    /**
+     * This is the recursive function for the intro sort algorithm. It recurses on the smaller side of each partition
+     * and loops on the larger side, so the stack never grows past log2(n) frames.
+     * @param first The first element iterator (should be 0 if first recursion call)
+     * @param last The last element iterator + 1
+     * @param depthLimit How many more partitions this range may go through before switching to heap sort
+     * @IMPORTANT DO NOT RUN THIS FUNCTION! IT IS TO BE CALLED FROM THE runSort() WITHOUT ANY PARAMS!!!
+     */
+    template<typename T>
+    void Intro<T>::runSort(unsigned int first, unsigned int last, unsigned int depthLimit) {
+        while (last - first > smallRangeCutoff) {
+            if (depthLimit == 0) {
+                heapSort(first, last);
+                return;
+            }
+            depthLimit--;
 
-        if (right < lastUnsortedIndex && this->arr[right] > this->arr[largest])
-            largest = right;
+            movePivotToFirst(first, last);
+            unsigned int pivotLocation = partition(first, last);
+            if (pivotLocation - first < last - pivotLocation) {
+                runSort(first, pivotLocation, depthLimit);
+                first = pivotLocation + 1;
+            } else {
+                runSort(pivotLocation + 1, last, depthLimit);
+                last = pivotLocation;
+            }
+        }
+        sortSmallRange(first, last);
+    }
 
-        // Swap and continue heapifying if root is not largest
-        if (largest != parent) {
-            T temp = this->arr[parent];
-            this->arr[parent] = this->arr[largest];
-            this->arr[largest] = temp;
-            heapify(lastUnsortedIndex, largest);
+    /**
+     * Partitions around the pivot stored at first. Both scans stop on keys equal to the pivot, which is what keeps
+     * the repeated strategy from putting every key on one side.
+     * @return The final position of the pivot
+     */
+    template<typename T>
+    unsigned int Intro<T>::partition(unsigned int first, unsigned int last) {
+        T pivot = this->arr[first];
+        unsigned int left = first;
+        unsigned int right = last;
+        while (true) {
+            while (++left < last && this->arr[left] < pivot);
+            while (pivot < this->arr[--right]); // stops at first at the latest, since arr[first] is the pivot
+            if (left >= right) break;
+            KeyTypes::swapValues(this->arr[left], this->arr[right]);
         }
+        KeyTypes::swapValues(this->arr[first], this->arr[right]);
+        return right;
     }
 
     /**
-     * The logic for executing the heap sort algorithm.
+     * Picks the pivot and swaps it to first. Large ranges use Tukey's ninther (the median of three medians of 3)
      */
     template<typename T>
-    void Heap<T>::runSort() {
+    void Intro<T>::movePivotToFirst(unsigned int first, unsigned int last) {
+        unsigned int size = last - first;
+        unsigned int middle = first + size / 2;
+        unsigned int median;
+        if (size > nintherCutoff) {
+            unsigned int step = size / 8;
+            median = medianOfThree(
+                    medianOfThree(first, first + step, first + 2 * step),
+                    medianOfThree(middle - step, middle, middle + step),
+                    medianOfThree(last - 1 - 2 * step, last - 1 - step, last - 1)
+            );
+        } else {
+            median = medianOfThree(first, middle, last - 1);
+        }
+        KeyTypes::swapValues(this->arr[first], this->arr[median]);
+    }
 
-        // Put tree in max heap (all parents bigger than their children)
-        unsigned int i = this->capacity / 2;
-        while (i > 0) {
-            i--;
-            heapify(this->capacity, i);
+    /**
+     * @return Whichever of the three indexes holds the median value
+     */
+    template<typename T>
+    unsigned int Intro<T>::medianOfThree(unsigned int a, unsigned int b, unsigned int c) const {
+        if (this->arr[a] < this->arr[b]) {
+            if (this->arr[b] < this->arr[c]) return b;
+            return this->arr[a] < this->arr[c] ? c : a;
         }
+        if (this->arr[a] < this->arr[c]) return a;
+        return this->arr[b] < this->arr[c] ? c : b;
+    }
 
-        // Swap root to sorted position, re-heap, repeat.
-        unsigned int lastUnsortedIndex = this->capacity;
-        while (lastUnsortedIndex > 0) {
-            lastUnsortedIndex--;
-            T temp = this->arr[0];
-            this->arr[0] = this->arr[lastUnsortedIndex];
-            this->arr[lastUnsortedIndex] = temp;
-            heapify(lastUnsortedIndex, 0);
+    template<typename T>
+    void Intro<T>::insertionSort(unsigned int first, unsigned int last) {
+        for (unsigned int i = first + 1; i < last; i++) {
+            T value = this->arr[i];
+            unsigned int j = i;
+            while (j > first && value < this->arr[j - 1]) {
+                this->arr[j] = this->arr[j - 1];
+                j--;
+            }
+            this->arr[j] = value;
         }
     }
 
     /**
-     * This is the class for handling the Merge Sort Algorithm.
+     * Heap sorts a sub range. Only used when a range has hit the depth limit
      */
     template<typename T>
-    class Merge : public BaseSort<T> {
+    void Intro<T>::heapSort(unsigned int first, unsigned int last) {
+        unsigned int size = last - first;
+        for (unsigned int i = size / 2; i > 0; i--) siftDown(first, size, i - 1);
+        for (unsigned int lastUnsorted = size - 1; lastUnsorted > 0; lastUnsorted--) {
+            KeyTypes::swapValues(this->arr[first], this->arr[first + lastUnsorted]);
+            siftDown(first, lastUnsorted, 0);
+        }
+    }
+
+    /**
+     * Moves a parent down the max heap that starts at first until both children are smaller
+     * @param first Where the heap starts in arr
+     * @param size How many values are in the heap
+     * @param parent The heap index (relative to first) to sift down
+     */
+    template<typename T>
+    void Intro<T>::siftDown(unsigned int first, unsigned int size, unsigned int parent) {
+        T value = this->arr[first + parent];
+        while (true) {
+            unsigned int child = 2 * parent + 1;
+            if (child >= size) break;
+            if (child + 1 < size && this->arr[first + child] < this->arr[first + child + 1]) child++;
+            if (!(value < this->arr[first + child])) break;
+            this->arr[first + parent] = this->arr[first + child];
+            parent = child;
+        }
+        this->arr[first + parent] = value;
+    }
+
+    /**
+     * This is the class for handling the Block Quick Sort Algorithm (BlockQuicksort, Edelkamp and Weiss). It is intro
+     * sort with a different partition: instead of branching on every comparison, a block of keys is compared and the
+     * offsets of misplaced keys are written to a buffer unconditionally, then misplaced keys from both ends are
+     * swapped in a second loop. The comparison results only ever feed an add, so random data no longer causes a
+     * branch misprediction on roughly every other key. Ranges of up to 64 unsigned ints are finished with a SIMD
+     * sorting network.
+     */
+    template<typename T>
+    class BlockQuick : public Intro<T> {
     public:
-        Merge(
+        BlockQuick(
                 const unsigned int capacity,
                 const string &canonicalName = "",
                 const bool &verbose = false,
                 const bool &includedValues = false,
                 const AlgoGauge::PERF& includePerf = perfOFF
-        ) : BaseSort<T>("Merge", capacity, canonicalName, verbose, includedValues, includePerf) {}
+        ) : Intro<T>("Block Quick", capacity, canonicalName, verbose, includedValues, includePerf) {
+            if constexpr (std::is_same<T, uint32_t>::value) this->smallRangeCutoff = SortingNetworks::maxBlockSize;
+        };
 
-        void runSort();
+    protected:
+        unsigned int partition(unsigned int first, unsigned int last) override;
+
+        /**
+         * 32 bit keys finish small ranges with a vectorized sorting network instead of insertion sort
+         */
+        void sortSmallRange(unsigned int first, unsigned int last) override {
+            if constexpr (std::is_same<T, uint32_t>::value) SortingNetworks::sortBlock(this->arr + first, last - first);
+            else this->insertionSort(first, last);
+        }
 
     private:
-        void runSort(unsigned int firstIndex, unsigned int lastIndex);
+        static constexpr unsigned int blockSize = 128; // must fit in the unsigned char offsets
     };
 
-
     /**
-     * This is the starter function for the merge sort algorithm.
-     * @IMPORTANT Only run this function as it starts the other is a recursive function
+     * Block partitions around the pivot stored at first. Keys equal to the pivot count as misplaced on both sides, so
+     * the repeated strategy still splits evenly. Once fewer than two blocks are left, the rest of the range is
+     * finished with the same scanning partition Intro uses.
+     * @return The final position of the pivot
      */
     template<typename T>
-    void Merge<T>::runSort() {
-        runSort(0, this->capacity);
+    unsigned int BlockQuick<T>::partition(unsigned int first, unsigned int last) {
+        T pivot = this->arr[first];
+        unsigned int left = first + 1; // first key of the left block
+        unsigned int right = last - 1; // last key of the right block (blocks on the right run backwards)
+        unsigned char offsetsLeft[blockSize];
+        unsigned char offsetsRight[blockSize];
+        unsigned int startLeft = 0, startRight = 0;
+        unsigned int countLeft = 0, countRight = 0;
+
+        while (right - left + 1 > 2 * blockSize) {
+            if (countLeft == 0) {
+                startLeft = 0;
+                for (unsigned int i = 0; i < blockSize; i++) {
+                    offsetsLeft[countLeft] = static_cast<unsigned char>(i);
+                    countLeft += !(this->arr[left + i] < pivot);
+                }
+            }
+            if (countRight == 0) {
+                startRight = 0;
+                for (unsigned int i = 0; i < blockSize; i++) {
+                    offsetsRight[countRight] = static_cast<unsigned char>(i);
+                    countRight += !(pivot < this->arr[right - i]);
+                }
+            }
+
+            unsigned int swaps = std::min(countLeft, countRight);
+            for (unsigned int i = 0; i < swaps; i++) {
+                KeyTypes::swapValues(this->arr[left + offsetsLeft[startLeft + i]], this->arr[right - offsetsRight[startRight + i]]);
+            }
+            countLeft -= swaps;
+            countRight -= swaps;
+            startLeft += swaps;
+            startRight += swaps;
+
+            if (countLeft == 0) left += blockSize;
+            if (countRight == 0) right -= blockSize;
+        }
+
+        // Everything before left is <= pivot and everything after right is >= pivot, so a plain scanning partition
+        // over the remaining window (including any block that still has misplaced keys) finishes the job.
+        unsigned int scanLeft = left - 1;
+        unsigned int scanRight = right + 1;
+        while (true) {
+            while (++scanLeft < last && this->arr[scanLeft] < pivot);
+            while (pivot < this->arr[--scanRight]);
+            if (scanLeft >= scanRight) break;
+            KeyTypes::swapValues(this->arr[scanLeft], this->arr[scanRight]);
+        }
+        KeyTypes::swapValues(this->arr[first], this->arr[scanRight]);
+        return scanRight;
     }
 
     /**
-     * This is the recursive function for the merge sort algorithm.
-     * @param firstIndex The first element iterator (should be 0 if first recursion call)
-     * @param lastIndex The last element iterator + 1
-     * @IMPORTANT DO NOT RUN THIS FUNCTION! IT IS TO BE CALLED FROM THE runSort() WITHOUT ANY PARAMS!!!
+     * This is the class for handling the Parallel Quick Sort Algorithm. Each thread owns a deque of unsorted ranges.
+     * A thread partitions a range once, pushes one side onto its own deque and keeps working on the other side. Idle
+     * threads steal the oldest (largest) range from the front of another thread's deque. Ranges at or below the
+     * cutoff are finished sequentially. Ranges are partitioned three ways, so keys equal to the pivot are placed in
+     * one pass and never handed out as work.
      */
     template<typename T>
-    void Merge<T>::runSort(unsigned int firstIndex, unsigned int lastIndex) {
-        if (lastIndex - firstIndex < 2) {
-            return;
+    class ParallelQuick : public Quick<T> {
+    public:
+        ParallelQuick(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF,
+                const unsigned int threads = 0,
+                const unsigned int cutoff = 0
+        ) : Quick<T>("Parallel Quick", capacity, canonicalName, verbose, includedValues, includePerf),
+            pool(threads),
+            workQueues(pool.size()) {
+            this->threadCount = pool.size();
+            this->cutoff = cutoff > 0 ? cutoff : defaultCutoff;
         }
 
-        // Find a middle
-        unsigned int middleIndex = (lastIndex - firstIndex) / 2 + firstIndex;
+        void runSort();
 
-        runSort(firstIndex, middleIndex);
-        runSort(middleIndex, lastIndex);
+    private:
+        struct Range {
+            unsigned int first;
+            unsigned int last;
+        };
+
+        struct WorkQueue {
+            std::mutex lock;
+            std::deque<Range> ranges;
+        };
+
+        void runWorker(unsigned int workerIndex);
+        bool popRange(unsigned int workerIndex, Range &range);
+        bool stealRange(unsigned int workerIndex, Range &range);
+        void pushRange(unsigned int workerIndex, const Range &range);
+        void sortSequential(unsigned int first, unsigned int last);
+        void moveMedianToFirst(unsigned int first, unsigned int last);
+        Range partition(unsigned int first, unsigned int last);
+
+        ThreadPool pool;
+        std::vector<WorkQueue> workQueues;
+        std::atomic<unsigned int> elementsPlaced{0}; // Elements known to be in their final position
+        unsigned int cutoff;
+        static constexpr unsigned int defaultCutoff = 4096;
+    };
+
+    /**
+     * This is the starter function for the parallel quick sort algorithm. The whole array is handed to the calling
+     * thread, every other thread starts out idle and steals.
+     */
+    template<typename T>
+    void ParallelQuick<T>::runSort() {
+        elementsPlaced.store(0);
+        pushRange(0, {0, this->capacity});
+
+        std::atomic<unsigned int> pending{0};
+        for (unsigned int i = 1; i < this->threadCount; i++) {
+            pool.submit([this, i] { runWorker(i); }, pending);
+        }
+        runWorker(0);
+        pool.wait(pending);
+    }
+
+    /**
+     * The loop each thread runs until every element has been placed
+     * @param workerIndex Which deque belongs to this thread
+     */
+    template<typename T>
+    void ParallelQuick<T>::runWorker(unsigned int workerIndex) {
+        Range range{};
+        while (elementsPlaced.load(std::memory_order_acquire) < this->capacity) {
+            if (!popRange(workerIndex, range) && !stealRange(workerIndex, range)) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            while (range.last - range.first > cutoff) {
+                moveMedianToFirst(range.first, range.last);
+                const Range equal = partition(range.first, range.last);
+                elementsPlaced.fetch_add(equal.last - equal.first, std::memory_order_release);
+
+                // share the larger side and keep the smaller one, which keeps each deque shallow
+                Range left{range.first, equal.first};
+                Range right{equal.last, range.last};
+                if (left.last - left.first > right.last - right.first) std::swap(left, right);
+                if (right.last > right.first) pushRange(workerIndex, right);
+                range = left;
+            }
+
+            sortSequential(range.first, range.last);
+            elementsPlaced.fetch_add(range.last - range.first, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Takes the newest range from this thread's own deque
+     * @return true if a range was found
+     */
+    template<typename T>
+    bool ParallelQuick<T>::popRange(unsigned int workerIndex, Range &range) {
+        WorkQueue &queue = workQueues[workerIndex];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.ranges.empty()) return false;
+        range = queue.ranges.back();
+        queue.ranges.pop_back();
+        return true;
+    }
+
+    /**
+     * Takes the oldest range from any other thread's deque, starting with the next thread over
+     * @return true if a range was stolen
+     */
+    template<typename T>
+    bool ParallelQuick<T>::stealRange(unsigned int workerIndex, Range &range) {
+        for (unsigned int i = 1; i < this->threadCount; i++) {
+            WorkQueue &victim = workQueues[(workerIndex + i) % this->threadCount];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.ranges.empty()) continue;
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    template<typename T>
+    void ParallelQuick<T>::pushRange(unsigned int workerIndex, const Range &range) {
+        WorkQueue &queue = workQueues[workerIndex];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.ranges.push_back(range);
+    }
+
+    /**
+     * Sorts a range below the cutoff on the current thread. Recursing on the smaller side and looping on the larger
+     * one keeps the stack depth logarithmic.
+     * @param first The first element iterator
+     * @param last The last element iterator + 1
+     */
+    template<typename T>
+    void ParallelQuick<T>::sortSequential(unsigned int first, unsigned int last) {
+        while (last - first > 1) {
+            moveMedianToFirst(first, last);
+            const Range equal = partition(first, last);
+            if (equal.first - first < last - equal.last) {
+                sortSequential(first, equal.first);
+                first = equal.last;
+            } else {
+                sortSequential(equal.last, last);
+                last = equal.first;
+            }
+        }
+    }
+
+    /**
+     * Partitions around the pivot stored at first into keys less than, equal to and greater than it. A strict two way
+     * partition puts every equal key on one side, which makes the repeated strategy quadratic. This is Bentley and
+     * McIlroy's three way partition: it scans from both ends like Intro::partition(), so sorted ranges still split
+     * in the middle, parks the keys equal to the pivot at both ends, and swaps them into the middle at the end.
+     * @return The range holding the keys equal to the pivot, which are all in their final positions
+     */
+    template<typename T>
+    typename ParallelQuick<T>::Range ParallelQuick<T>::partition(unsigned int first, unsigned int last) {
+        T pivot = this->arr[first];
+        unsigned int left = first;
+        unsigned int right = last;
+        unsigned int leftEqualEnd = first + 1; // [first, leftEqualEnd) are equal to the pivot
+        unsigned int rightEqualStart = last; // and so are [rightEqualStart, last)
+        while (true) {
+            while (++left < last && this->arr[left] < pivot);
+            while (pivot < this->arr[--right]); // stops at first at the latest, since arr[first] is the pivot
+            if (left >= right) break;
+            KeyTypes::swapValues(this->arr[left], this->arr[right]);
+            if (!(this->arr[left] < pivot)) KeyTypes::swapValues(this->arr[leftEqualEnd++], this->arr[left]);
+            if (!(pivot < this->arr[right])) KeyTypes::swapValues(this->arr[--rightEqualStart], this->arr[right]);
+        }
+
+        // now [leftEqualEnd, lessEnd) < pivot, [lessEnd, greaterStart) == pivot and [greaterStart, rightEqualStart) > pivot,
+        // where arr[right] is the one key that may be either less or equal
+        const unsigned int greaterStart = right + 1;
+        unsigned int lessEnd = greaterStart;
+        if (right < leftEqualEnd) lessEnd = leftEqualEnd;
+        else if (!(this->arr[right] < pivot)) lessEnd = right;
+
+        const unsigned int lessCount = lessEnd - leftEqualEnd;
+        const unsigned int leftSwaps = std::min(leftEqualEnd - first, lessCount);
+        for (unsigned int i = 0; i < leftSwaps; i++) KeyTypes::swapValues(this->arr[first + i], this->arr[lessEnd - leftSwaps + i]);
+        const unsigned int greaterCount = rightEqualStart - greaterStart;
+        const unsigned int rightSwaps = std::min(last - rightEqualStart, greaterCount);
+        for (unsigned int i = 0; i < rightSwaps; i++) KeyTypes::swapValues(this->arr[greaterStart + i], this->arr[last - rightSwaps + i]);
+
+        return {first + lessCount, last - greaterCount};
+    }
+
+    /**
+     * Swaps the median of the first, middle and last values into first, where partition() takes its pivot.
+     * Without this an already sorted range would only ever split off one element at a time.
+     */
+    template<typename T>
+    void ParallelQuick<T>::moveMedianToFirst(unsigned int first, unsigned int last) {
+        unsigned int middle = first + (last - first) / 2;
+        unsigned int back = last - 1;
+        unsigned int median;
+        if (this->arr[first] < this->arr[middle]) {
+            if (this->arr[middle] < this->arr[back]) median = middle;
+            else median = this->arr[first] < this->arr[back] ? back : first;
+        } else {
+            if (this->arr[first] < this->arr[back]) median = first;
+            else median = this->arr[middle] < this->arr[back] ? back : middle;
+        }
+        KeyTypes::swapValues(this->arr[first], this->arr[median]);
+    }
+
+    /**
+     * This is the class for handling the Heap Sort Algorithm.
+     */
+    template<typename T>
+    class Heap : public BaseSort<T> {
+    public:
+        Heap(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : BaseSort<T>("Heap", capacity, canonicalName, verbose, includedValues, includePerf) {};
+
+        void runSort();
+
+    private:
+        void heapify(unsigned int lastUnsortedIndex, unsigned int parent);
+    };
+
+    template<typename T>
+    void Heap<T>::heapify(unsigned int lastUnsortedIndex, unsigned int parent) {
+        // Find largest among root, left child and right child
+        unsigned int largest = parent;
+        unsigned int left = 2 * parent + 1;
+        unsigned int right = 2 * parent + 2;
+
+        if (left < lastUnsortedIndex && this->arr[left] > this->arr[largest])
+            largest = left;
+
+        if (right < lastUnsortedIndex && this->arr[right] > this->arr[largest])
+            largest = right;
+
+        // Swap and continue heapifying if root is not largest
+        if (largest != parent) {
+            KeyTypes::swapValues(this->arr[parent], this->arr[largest]);
+            heapify(lastUnsortedIndex, largest);
+        }
+    }
+
+    /**
+     * The logic for executing the heap sort algorithm.
+     */
+    template<typename T>
+    void Heap<T>::runSort() {
+
+        // Put tree in max heap (all parents bigger than their children)
+        unsigned int i = this->capacity / 2;
+        while (i > 0) {
+            i--;
+            heapify(this->capacity, i);
+        }
+
+        // Swap root to sorted position, re-heap, repeat.
+        unsigned int lastUnsortedIndex = this->capacity;
+        while (lastUnsortedIndex > 0) {
+            lastUnsortedIndex--;
+            KeyTypes::swapValues(this->arr[0], this->arr[lastUnsortedIndex]);
+            heapify(lastUnsortedIndex, 0);
+        }
+    }
+
+    /**
+     * This is the class for handling the Merge Sort Algorithm.
+     */
+    template<typename T>
+    class Merge : public BaseSort<T> {
+    public:
+        Merge(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : BaseSort<T>("Merge", capacity, canonicalName, verbose, includedValues, includePerf) {}
+
+        void runSort();
+
+    private:
+        void runSort(unsigned int firstIndex, unsigned int lastIndex);
+    };
+
+
+    /**
+     * This is the starter function for the merge sort algorithm.
+     * @IMPORTANT Only run this function as it starts the other is a recursive function
+     */
+    template<typename T>
+    void Merge<T>::runSort() {
+        runSort(0, this->capacity);
+    }
+
+    /**
+     * This is the recursive function for the merge sort algorithm.
+     * @param firstIndex The first element iterator (should be 0 if first recursion call)
+     * @param lastIndex The last element iterator + 1
+     * @IMPORTANT DO NOT RUN THIS FUNCTION! IT IS TO BE CALLED FROM THE runSort() WITHOUT ANY PARAMS!!!
+     */
+    template<typename T>
+    void Merge<T>::runSort(unsigned int firstIndex, unsigned int lastIndex) {
+        if (lastIndex - firstIndex < 2) {
+            return;
+        }
+
+        // Find a middle
+        unsigned int middleIndex = (lastIndex - firstIndex) / 2 + firstIndex;
+
+        runSort(firstIndex, middleIndex);
+        runSort(middleIndex, lastIndex);
 
         unsigned int leftHalfSize = middleIndex - firstIndex;
         T *leftArray = new T[leftHalfSize];
@@ -789,194 +1889,1156 @@ void Bubble<T>::runSort() {
         unsigned int rightIndex = 0;
         unsigned int arrIndex = firstIndex;
 
-        while (leftIndex < leftHalfSize && rightIndex < rightHalfSize) {
-            if (leftArray[leftIndex] <= rightArray[rightIndex]) {
-                this->arr[arrIndex] = leftArray[leftIndex];
-                leftIndex++;
-            } else {
-                this->arr[arrIndex] = rightArray[rightIndex];
-                rightIndex++;
+        while (leftIndex < leftHalfSize && rightIndex < rightHalfSize) {
+            if (leftArray[leftIndex] <= rightArray[rightIndex]) {
+                this->arr[arrIndex] = leftArray[leftIndex];
+                leftIndex++;
+            } else {
+                this->arr[arrIndex] = rightArray[rightIndex];
+                rightIndex++;
+            }
+            arrIndex++;
+        }
+        while (leftIndex < leftHalfSize) {
+            this->arr[arrIndex] = leftArray[leftIndex];
+            leftIndex++;
+            arrIndex++;
+        }
+        while (rightIndex < rightHalfSize) {
+            this->arr[arrIndex] = rightArray[rightIndex];
+            rightIndex++;
+            arrIndex++;
+        }
+        delete[] leftArray;
+        delete[] rightArray;
+
+    }
+
+
+    /**
+     * This is the class for handling the Tim Sort Algorithm. It walks the array looking for natural runs (reversing
+     * strictly descending ones), extends short runs to minRun with binary insertion sort, and keeps the runs on a
+     * stack that is merged whenever the run lengths stop shrinking fast enough. Merges switch to galloping (exponential
+     * search) when one run keeps winning, which is what lets partially sorted data sort in close to linear time.
+     */
+    template<typename T>
+    class Tim : public BaseSort<T> {
+    public:
+        Tim(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : BaseSort<T>("Tim", capacity, canonicalName, verbose, includedValues, includePerf) {}
+
+        ~Tim() { this->freeBuffer(scratch, scratchCapacity()); }
+
+        void runSort();
+
+    protected:
+        void allocateBuffers() override { if (scratch == nullptr) scratch = this->allocateBuffer(scratchCapacity()); }
+
+    private:
+        // a merge only ever copies out the shorter of its two runs
+        unsigned int scratchCapacity() const { return this->capacity / 2 + 1; }
+
+        struct Run {
+            unsigned int base;
+            unsigned int length;
+        };
+
+        static unsigned int computeMinRun(unsigned int length);
+        unsigned int countRunAndMakeAscending(unsigned int first, unsigned int last);
+        void binaryInsertionSort(unsigned int first, unsigned int last, unsigned int start);
+        void mergeCollapse();
+        void mergeForceCollapse();
+        void mergeAt(unsigned int runIndex);
+        void mergeLow(unsigned int base1, unsigned int length1, unsigned int base2, unsigned int length2);
+        void mergeHigh(unsigned int base1, unsigned int length1, unsigned int base2, unsigned int length2);
+        static unsigned int gallopLeft(const T &key, const T *run, unsigned int length, unsigned int hint);
+        static unsigned int gallopRight(const T &key, const T *run, unsigned int length, unsigned int hint);
+
+        T *scratch{nullptr};
+        std::vector<Run> runs;
+        long minGallop{initialMinGallop}; // Adapts per merge: drops while galloping pays off, rises when it doesn't
+
+        static constexpr unsigned int minMerge = 32;
+        static constexpr long initialMinGallop = 7;
+    };
+
+    /**
+     * The logic for executing the tim sort algorithm.
+     */
+    template<typename T>
+    void Tim<T>::runSort() {
+        if (this->capacity < 2) return;
+        runs.clear();
+        minGallop = initialMinGallop;
+
+        // short arrays are a single mini run
+        if (this->capacity < minMerge) {
+            unsigned int runLength = countRunAndMakeAscending(0, this->capacity);
+            binaryInsertionSort(0, this->capacity, runLength);
+            return;
+        }
+
+        unsigned int minRun = computeMinRun(this->capacity);
+        unsigned int first = 0;
+        unsigned int remaining = this->capacity;
+        do {
+            unsigned int runLength = countRunAndMakeAscending(first, this->capacity);
+            if (runLength < minRun) {
+                unsigned int forcedLength = std::min(remaining, minRun);
+                binaryInsertionSort(first, first + forcedLength, first + runLength);
+                runLength = forcedLength;
+            }
+            runs.push_back({first, runLength});
+            mergeCollapse();
+
+            first += runLength;
+            remaining -= runLength;
+        } while (remaining != 0);
+
+        mergeForceCollapse();
+    }
+
+    /**
+     * Picks a run length between minMerge / 2 and minMerge so that length / minRun is a power of two, or just under
+     * one, which keeps the final merges balanced
+     */
+    template<typename T>
+    unsigned int Tim<T>::computeMinRun(unsigned int length) {
+        unsigned int lowBitsSet = 0;
+        while (length >= minMerge) {
+            lowBitsSet |= length & 1;
+            length >>= 1;
+        }
+        return length + lowBitsSet;
+    }
+
+    /**
+     * Finds the length of the run starting at first. A strictly descending run is reversed in place, strictly so that
+     * reversing can't reorder equal keys.
+     * @return The length of the run
+     */
+    template<typename T>
+    unsigned int Tim<T>::countRunAndMakeAscending(unsigned int first, unsigned int last) {
+        unsigned int runEnd = first + 1;
+        if (runEnd == last) return 1;
+
+        if (this->arr[runEnd++] < this->arr[first]) {
+            while (runEnd < last && this->arr[runEnd] < this->arr[runEnd - 1]) runEnd++;
+            std::reverse(this->arr + first, this->arr + runEnd);
+        } else {
+            while (runEnd < last && !(this->arr[runEnd] < this->arr[runEnd - 1])) runEnd++;
+        }
+        return runEnd - first;
+    }
+
+    /**
+     * Insertion sort that binary searches for each key's position, so it only does O(n log n) comparisons
+     * @param start Everything in [first, start) is already sorted
+     */
+    template<typename T>
+    void Tim<T>::binaryInsertionSort(unsigned int first, unsigned int last, unsigned int start) {
+        if (start == first) start++;
+        for (; start < last; start++) {
+            T pivot = this->arr[start];
+            unsigned int left = first;
+            unsigned int right = start;
+            while (left < right) {
+                unsigned int middle = left + (right - left) / 2;
+                if (pivot < this->arr[middle]) right = middle;
+                else left = middle + 1;
+            }
+            std::move_backward(this->arr + left, this->arr + start, this->arr + start + 1);
+            this->arr[left] = pivot;
+        }
+    }
+
+    /**
+     * Merges runs on the stack until the run lengths satisfy, for the top runs A, B, C, D (D on top):
+     * B > C + D, A > B + C and C > D. This keeps the stack O(log n) deep and the merges balanced.
+     */
+    template<typename T>
+    void Tim<T>::mergeCollapse() {
+        while (runs.size() > 1) {
+            unsigned int n = runs.size() - 2;
+            if ((n > 0 && runs[n - 1].length <= runs[n].length + runs[n + 1].length) ||
+                (n > 1 && runs[n - 2].length <= runs[n - 1].length + runs[n].length)) {
+                if (runs[n - 1].length < runs[n + 1].length) n--;
+            } else if (runs[n].length > runs[n + 1].length) {
+                break;
+            }
+            mergeAt(n);
+        }
+    }
+
+    /**
+     * Merges every run left on the stack. Only called once the whole array has been split into runs
+     */
+    template<typename T>
+    void Tim<T>::mergeForceCollapse() {
+        while (runs.size() > 1) {
+            unsigned int n = runs.size() - 2;
+            if (n > 0 && runs[n - 1].length < runs[n + 1].length) n--;
+            mergeAt(n);
+        }
+    }
+
+    /**
+     * Merges runs[runIndex] with runs[runIndex + 1]. Keys at the start of the first run that are already before the
+     * whole second run, and keys at the end of the second run already after the whole first run, are skipped.
+     */
+    template<typename T>
+    void Tim<T>::mergeAt(unsigned int runIndex) {
+        unsigned int base1 = runs[runIndex].base;
+        unsigned int length1 = runs[runIndex].length;
+        unsigned int base2 = runs[runIndex + 1].base;
+        unsigned int length2 = runs[runIndex + 1].length;
+
+        runs[runIndex].length = length1 + length2;
+        if (runIndex + 3 == runs.size()) runs[runIndex + 1] = runs[runIndex + 2];
+        runs.pop_back();
+
+        unsigned int skip = gallopRight(this->arr[base2], this->arr + base1, length1, 0);
+        base1 += skip;
+        length1 -= skip;
+        if (length1 == 0) return;
+
+        length2 = gallopLeft(this->arr[base1 + length1 - 1], this->arr + base2, length2, length2 - 1);
+        if (length2 == 0) return;
+
+        if (length1 <= length2) mergeLow(base1, length1, base2, length2);
+        else mergeHigh(base1, length1, base2, length2);
+    }
+
+    /**
+     * Merges two adjacent runs front to back, copying the first (shorter) run into the scratch array
+     */
+    template<typename T>
+    void Tim<T>::mergeLow(unsigned int base1, unsigned int length1, unsigned int base2, unsigned int length2) {
+        std::copy(this->arr + base1, this->arr + base1 + length1, scratch);
+        T *arr = this->arr;
+        unsigned int cursor1 = 0; // into scratch
+        unsigned int cursor2 = base2;
+        unsigned int destination = base1;
+
+        // the first key of run 2 is known to go first (see mergeAt)
+        arr[destination++] = arr[cursor2++];
+        if (--length2 == 0) {
+            std::copy(scratch + cursor1, scratch + cursor1 + length1, arr + destination);
+            return;
+        }
+        if (length1 == 1) {
+            std::copy(arr + cursor2, arr + cursor2 + length2, arr + destination);
+            arr[destination + length2] = scratch[cursor1];
+            return;
+        }
+
+        while (true) {
+            unsigned int count1 = 0; // how many times in a row run 1 won
+            unsigned int count2 = 0; // how many times in a row run 2 won
+
+            // one key at a time until one run starts winning consistently
+            do {
+                if (arr[cursor2] < scratch[cursor1]) {
+                    arr[destination++] = arr[cursor2++];
+                    count2++;
+                    count1 = 0;
+                    if (--length2 == 0) goto mergeDone;
+                } else {
+                    arr[destination++] = scratch[cursor1++];
+                    count1++;
+                    count2 = 0;
+                    if (--length1 == 1) goto mergeDone;
+                }
+            } while (static_cast<long>(count1 | count2) < minGallop);
+
+            // galloping: search for how far the winning run keeps winning and copy that whole stretch at once
+            do {
+                count1 = gallopRight(arr[cursor2], scratch + cursor1, length1, 0);
+                if (count1 != 0) {
+                    std::copy(scratch + cursor1, scratch + cursor1 + count1, arr + destination);
+                    destination += count1;
+                    cursor1 += count1;
+                    length1 -= count1;
+                    if (length1 <= 1) goto mergeDone;
+                }
+                arr[destination++] = arr[cursor2++];
+                if (--length2 == 0) goto mergeDone;
+
+                count2 = gallopLeft(scratch[cursor1], arr + cursor2, length2, 0);
+                if (count2 != 0) {
+                    std::copy(arr + cursor2, arr + cursor2 + count2, arr + destination);
+                    destination += count2;
+                    cursor2 += count2;
+                    length2 -= count2;
+                    if (length2 == 0) goto mergeDone;
+                }
+                arr[destination++] = scratch[cursor1++];
+                if (--length1 == 1) goto mergeDone;
+                minGallop--;
+            } while (count1 >= initialMinGallop || count2 >= initialMinGallop);
+
+            if (minGallop < 0) minGallop = 0;
+            minGallop += 2; // penalize leaving gallop mode
+        }
+
+    mergeDone:
+        if (minGallop < 1) minGallop = 1;
+        if (length1 == 1) {
+            std::copy(arr + cursor2, arr + cursor2 + length2, arr + destination);
+            arr[destination + length2] = scratch[cursor1];
+        } else {
+            std::copy(scratch + cursor1, scratch + cursor1 + length1, arr + destination);
+        }
+    }
+
+    /**
+     * Merges two adjacent runs back to front, copying the second (shorter) run into the scratch array. Cursors are
+     * signed since they walk down past the start of a run.
+     */
+    template<typename T>
+    void Tim<T>::mergeHigh(unsigned int base1, unsigned int length1, unsigned int base2, unsigned int length2) {
+        std::copy(this->arr + base2, this->arr + base2 + length2, scratch);
+        T *arr = this->arr;
+        long cursor1 = static_cast<long>(base1 + length1) - 1;
+        long cursor2 = static_cast<long>(length2) - 1; // into scratch
+        long destination = static_cast<long>(base2 + length2) - 1;
+
+        // the last key of run 1 is known to go last (see mergeAt)
+        arr[destination--] = arr[cursor1--];
+        if (--length1 == 0) {
+            std::copy(scratch, scratch + length2, arr + destination - (length2 - 1));
+            return;
+        }
+        if (length2 == 1) {
+            destination -= length1;
+            cursor1 -= length1;
+            std::copy_backward(arr + cursor1 + 1, arr + cursor1 + 1 + length1, arr + destination + 1 + length1);
+            arr[destination] = scratch[cursor2];
+            return;
+        }
+
+        while (true) {
+            unsigned int count1 = 0;
+            unsigned int count2 = 0;
+
+            do {
+                if (scratch[cursor2] < arr[cursor1]) {
+                    arr[destination--] = arr[cursor1--];
+                    count1++;
+                    count2 = 0;
+                    if (--length1 == 0) goto mergeDone;
+                } else {
+                    arr[destination--] = scratch[cursor2--];
+                    count2++;
+                    count1 = 0;
+                    if (--length2 == 1) goto mergeDone;
+                }
+            } while (static_cast<long>(count1 | count2) < minGallop);
+
+            do {
+                count1 = length1 - gallopRight(scratch[cursor2], arr + base1, length1, length1 - 1);
+                if (count1 != 0) {
+                    destination -= count1;
+                    cursor1 -= count1;
+                    length1 -= count1;
+                    std::copy_backward(arr + cursor1 + 1, arr + cursor1 + 1 + count1, arr + destination + 1 + count1);
+                    if (length1 == 0) goto mergeDone;
+                }
+                arr[destination--] = scratch[cursor2--];
+                if (--length2 == 1) goto mergeDone;
+
+                count2 = length2 - gallopLeft(arr[cursor1], scratch, length2, length2 - 1);
+                if (count2 != 0) {
+                    destination -= count2;
+                    cursor2 -= count2;
+                    length2 -= count2;
+                    std::copy(scratch + cursor2 + 1, scratch + cursor2 + 1 + count2, arr + destination + 1);
+                    if (length2 <= 1) goto mergeDone;
+                }
+                arr[destination--] = arr[cursor1--];
+                if (--length1 == 0) goto mergeDone;
+                minGallop--;
+            } while (count1 >= initialMinGallop || count2 >= initialMinGallop);
+
+            if (minGallop < 0) minGallop = 0;
+            minGallop += 2;
+        }
+
+    mergeDone:
+        if (minGallop < 1) minGallop = 1;
+        if (length2 == 1) {
+            destination -= length1;
+            cursor1 -= length1;
+            std::copy_backward(arr + cursor1 + 1, arr + cursor1 + 1 + length1, arr + destination + 1 + length1);
+            arr[destination] = scratch[cursor2];
+        } else {
+            std::copy(scratch, scratch + length2, arr + destination - (length2 - 1));
+        }
+    }
+
+    /**
+     * Finds where key would be inserted into a sorted run, before any keys equal to it. Searches outward from hint
+     * in steps of 1, 3, 7, 15... and then binary searches the last step, so keys close to hint are found quickly.
+     * @return k such that run[k - 1] < key <= run[k]
+     */
+    template<typename T>
+    unsigned int Tim<T>::gallopLeft(const T &key, const T *run, unsigned int length, unsigned int hint) {
+        long lastOffset = 0;
+        long offset = 1;
+        long position = hint;
+        if (run[position] < key) {
+            // gallop right until run[hint + lastOffset] < key <= run[hint + offset]
+            long maxOffset = static_cast<long>(length) - position;
+            while (offset < maxOffset && run[position + offset] < key) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            if (offset > maxOffset) offset = maxOffset;
+            lastOffset += position;
+            offset += position;
+        } else {
+            // gallop left until run[hint - offset] < key <= run[hint - lastOffset]
+            long maxOffset = position + 1;
+            while (offset < maxOffset && !(run[position - offset] < key)) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            if (offset > maxOffset) offset = maxOffset;
+            long temp = lastOffset;
+            lastOffset = position - offset;
+            offset = position - temp;
+        }
+
+        lastOffset++;
+        while (lastOffset < offset) {
+            long middle = lastOffset + (offset - lastOffset) / 2;
+            if (run[middle] < key) lastOffset = middle + 1;
+            else offset = middle;
+        }
+        return static_cast<unsigned int>(offset);
+    }
+
+    /**
+     * Like gallopLeft(), except key goes after any keys equal to it
+     * @return k such that run[k - 1] <= key < run[k]
+     */
+    template<typename T>
+    unsigned int Tim<T>::gallopRight(const T &key, const T *run, unsigned int length, unsigned int hint) {
+        long lastOffset = 0;
+        long offset = 1;
+        long position = hint;
+        if (key < run[position]) {
+            long maxOffset = position + 1;
+            while (offset < maxOffset && key < run[position - offset]) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            if (offset > maxOffset) offset = maxOffset;
+            long temp = lastOffset;
+            lastOffset = position - offset;
+            offset = position - temp;
+        } else {
+            long maxOffset = static_cast<long>(length) - position;
+            while (offset < maxOffset && !(key < run[position + offset])) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            if (offset > maxOffset) offset = maxOffset;
+            lastOffset += position;
+            offset += position;
+        }
+
+        lastOffset++;
+        while (lastOffset < offset) {
+            long middle = lastOffset + (offset - lastOffset) / 2;
+            if (key < run[middle]) offset = middle;
+            else lastOffset = middle + 1;
+        }
+        return static_cast<unsigned int>(offset);
+    }
+
+    /**
+     * This is the class for handling the Buffered Merge Sort Algorithm. It is the same top-down merge sort as Merge,
+     * except one scratch array is allocated up front and the two halves ping-pong between arr and the scratch array,
+     * so no memory is allocated or copied out while sorting. With NetworkBase (Network Merge), ranges of up to 64
+     * unsigned 32 bit ints are sorted with a SIMD sorting network instead of being merged up from single keys. That
+     * is its own algorithm, so Buffered Merge still differs from Merge only in how it allocates.
+     */
+    template<typename T, bool NetworkBase = false>
+    class BufferedMerge : public BaseSort<T> {
+        static_assert(!NetworkBase || std::is_same<T, uint32_t>::value, "The sorting network kernels only sort unsigned 32 bit ints");
+
+    public:
+        BufferedMerge(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : BaseSort<T>(NetworkBase ? "Network Merge" : "Buffered Merge", capacity, canonicalName, verbose, includedValues, includePerf) {}
+
+        ~BufferedMerge() { this->freeBuffer(scratch, this->capacity); }
+
+        void runSort();
+
+    protected:
+        void allocateBuffers() override { if (scratch == nullptr) scratch = this->allocateBuffer(this->capacity); }
+
+    private:
+        void runSort(unsigned int firstIndex, unsigned int lastIndex, bool intoScratch);
+
+        T *scratch{nullptr};
+    };
+
+    /**
+     * This is the starter function for the buffered merge sort algorithm.
+     * @IMPORTANT Only run this function as it starts the other is a recursive function
+     */
+    template<typename T, bool NetworkBase>
+    void BufferedMerge<T, NetworkBase>::runSort() {
+        runSort(0, this->capacity, false);
+    }
+
+    /**
+     * This is the recursive function for the buffered merge sort algorithm. Each half is sorted into the opposite
+     * buffer of the one this call has to fill, then the halves are merged into the requested buffer.
+     * @param firstIndex The first element iterator (should be 0 if first recursion call)
+     * @param lastIndex The last element iterator + 1
+     * @param intoScratch Whether the sorted range should end up in the scratch buffer (true) or arr (false)
+     * @IMPORTANT DO NOT RUN THIS FUNCTION! IT IS TO BE CALLED FROM THE runSort() WITHOUT ANY PARAMS!!!
+     */
+    template<typename T, bool NetworkBase>
+    void BufferedMerge<T, NetworkBase>::runSort(unsigned int firstIndex, unsigned int lastIndex, bool intoScratch) {
+        if constexpr (NetworkBase) {
+            // the range is still unsorted in arr, so it can be sorted there and copied over if scratch needs it
+            if (lastIndex - firstIndex <= SortingNetworks::maxBlockSize) {
+                SortingNetworks::sortBlock(this->arr + firstIndex, lastIndex - firstIndex);
+                if (intoScratch) std::copy(this->arr + firstIndex, this->arr + lastIndex, scratch + firstIndex);
+                return;
+            }
+        }
+        if (lastIndex - firstIndex < 2) {
+            if (intoScratch && lastIndex > firstIndex) scratch[firstIndex] = this->arr[firstIndex];
+            return;
+        }
+
+        unsigned int middleIndex = (lastIndex - firstIndex) / 2 + firstIndex;
+
+        runSort(firstIndex, middleIndex, !intoScratch);
+        runSort(middleIndex, lastIndex, !intoScratch);
+
+        const T *source = intoScratch ? this->arr : scratch;
+        T *destination = intoScratch ? scratch : this->arr;
+        unsigned int leftIndex = firstIndex;
+        unsigned int rightIndex = middleIndex;
+        unsigned int destinationIndex = firstIndex;
+
+        while (leftIndex < middleIndex && rightIndex < lastIndex) {
+            if (source[leftIndex] <= source[rightIndex]) {
+                destination[destinationIndex] = source[leftIndex];
+                leftIndex++;
+            } else {
+                destination[destinationIndex] = source[rightIndex];
+                rightIndex++;
+            }
+            destinationIndex++;
+        }
+        while (leftIndex < middleIndex) {
+            destination[destinationIndex] = source[leftIndex];
+            leftIndex++;
+            destinationIndex++;
+        }
+        while (rightIndex < lastIndex) {
+            destination[destinationIndex] = source[rightIndex];
+            rightIndex++;
+            destinationIndex++;
+        }
+    }
+
+    /**
+     * This is the class for handling the Bitonic Merge Sort Algorithm. The array is cut into blocks of 64 that are
+     * each sorted in registers by a bitonic sorting network, then the sorted blocks are merged bottom-up, ping-ponging
+     * between arr and a scratch array. The network runs on AVX2, SSE4.1 or plain scalar code, so the same input can
+     * be timed with and without vectorization. Only works for unsigned 32 bit ints.
+     */
+    template<typename T>
+    class Bitonic : public BaseSort<T> {
+        static_assert(std::is_same<T, uint32_t>::value, "The sorting network kernels only sort unsigned 32 bit ints");
+
+    public:
+        Bitonic(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF,
+                const SortingNetworks::Kernel kernel = SortingNetworks::detectKernel()
+        ) : BaseSort<T>("Bitonic (" + SortingNetworks::KernelStrings[kernel] + ")", capacity, canonicalName, verbose, includedValues, includePerf),
+            kernel(kernel) {}
+
+        ~Bitonic() { this->freeBuffer(scratch, this->capacity); }
+
+        void runSort();
+
+    protected:
+        void allocateBuffers() override { if (scratch == nullptr) scratch = this->allocateBuffer(this->capacity); }
+
+    private:
+        SortingNetworks::Kernel kernel;
+        T *scratch{nullptr};
+    };
+
+    /**
+     * The logic for executing the bitonic merge sort algorithm.
+     */
+    template<typename T>
+    void Bitonic<T>::runSort() {
+        // size_t, since doubling the width or stepping past the last block can go over 2^32 on large arrays
+        const size_t capacity = this->capacity;
+        const size_t blockSize = SortingNetworks::maxBlockSize;
+        for (size_t first = 0; first < capacity; first += blockSize) {
+            SortingNetworks::sortBlock(this->arr + first, static_cast<unsigned int>(std::min(blockSize, capacity - first)), kernel);
+        }
+
+        T *source = this->arr;
+        T *destination = scratch;
+        for (size_t width = blockSize; width < capacity; width *= 2) {
+            for (size_t first = 0; first < capacity; first += 2 * width) {
+                size_t middle = std::min(first + width, capacity);
+                size_t last = std::min(first + 2 * width, capacity);
+                std::merge(source + first, source + middle, source + middle, source + last, destination + first);
+            }
+            std::swap(source, destination);
+        }
+
+        if (source != this->arr) std::copy(source, source + this->capacity, this->arr);
+    }
+
+    /**
+     * This is the class for handling the Parallel Merge Sort Algorithm. The recursion is split across a thread pool
+     * and large merges are themselves split so every thread keeps working during the final (largest) merges.
+     */
+    template<typename T>
+    class ParallelMerge : public BaseSort<T> {
+    public:
+        ParallelMerge(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF,
+                const unsigned int threads = 0
+        ) : BaseSort<T>("Parallel Merge", capacity, canonicalName, verbose, includedValues, includePerf),
+            pool(threads) {
+            this->threadCount = pool.size();
+        }
+
+        ~ParallelMerge() { this->freeBuffer(scratch, this->capacity); }
+
+        void runSort();
+
+    protected:
+        void allocateBuffers() override { if (scratch == nullptr) scratch = this->allocateBuffer(this->capacity); }
+
+    private:
+        void runSort(unsigned int firstIndex, unsigned int lastIndex, bool intoScratch);
+
+        void mergeRange(
+                const T *source,
+                unsigned int leftFirst, unsigned int leftLast,
+                unsigned int rightFirst, unsigned int rightLast,
+                T *destination, unsigned int destinationIndex
+        );
+
+        ThreadPool pool;
+        T *scratch{nullptr};
+        unsigned int sortCutoff{0}; // Ranges at or below this size are sorted without forking a task
+        static constexpr unsigned int mergeCutoff = 8192; // Merges at or below this size are not split
+        static constexpr unsigned int insertionCutoff = 16;
+    };
+
+    /**
+     * This is the starter function for the parallel merge sort algorithm.
+     * @IMPORTANT Only run this function as it starts the other is a recursive function
+     */
+    template<typename T>
+    void ParallelMerge<T>::runSort() {
+        // roughly 8 tasks per thread gives the pool room to balance uneven ranges
+        sortCutoff = std::max(this->capacity / (this->threadCount * 8), 4096u);
+        runSort(0, this->capacity, false);
+    }
+
+    /**
+     * This is the recursive function for the parallel merge sort algorithm. Rather than copying each half out before
+     * merging, the two halves are sorted into the opposite buffer and merged back into the requested one.
+     * @param firstIndex The first element iterator (should be 0 if first recursion call)
+     * @param lastIndex The last element iterator + 1
+     * @param intoScratch Whether the sorted range should end up in the scratch buffer (true) or arr (false)
+     * @IMPORTANT DO NOT RUN THIS FUNCTION! IT IS TO BE CALLED FROM THE runSort() WITHOUT ANY PARAMS!!!
+     */
+    template<typename T>
+    void ParallelMerge<T>::runSort(unsigned int firstIndex, unsigned int lastIndex, bool intoScratch) {
+        if (lastIndex - firstIndex <= insertionCutoff) {
+            for (unsigned int i = firstIndex + 1; i < lastIndex; i++) {
+                T value = this->arr[i];
+                unsigned int j = i;
+                while (j > firstIndex && value < this->arr[j - 1]) {
+                    this->arr[j] = this->arr[j - 1];
+                    j--;
+                }
+                this->arr[j] = value;
             }
-            arrIndex++;
+            if (intoScratch) std::copy(this->arr + firstIndex, this->arr + lastIndex, scratch + firstIndex);
+            return;
         }
-        while (leftIndex < leftHalfSize) {
-            this->arr[arrIndex] = leftArray[leftIndex];
-            leftIndex++;
-            arrIndex++;
+
+        unsigned int middleIndex = (lastIndex - firstIndex) / 2 + firstIndex;
+
+        if (lastIndex - firstIndex > sortCutoff) {
+            std::atomic<unsigned int> pending{0};
+            pool.submit([=] { runSort(firstIndex, middleIndex, !intoScratch); }, pending);
+            runSort(middleIndex, lastIndex, !intoScratch);
+            pool.wait(pending);
+        } else {
+            runSort(firstIndex, middleIndex, !intoScratch);
+            runSort(middleIndex, lastIndex, !intoScratch);
         }
-        while (rightIndex < rightHalfSize) {
-            this->arr[arrIndex] = rightArray[rightIndex];
-            rightIndex++;
-            arrIndex++;
+
+        const T *source = intoScratch ? this->arr : scratch;
+        T *destination = intoScratch ? scratch : this->arr;
+        mergeRange(source, firstIndex, middleIndex, middleIndex, lastIndex, destination, firstIndex);
+    }
+
+    /**
+     * Merges two sorted ranges of source into destination. Large merges take the middle value of the larger range,
+     * binary search for its position in the smaller range, and merge the two independent halves in parallel.
+     * @param source The buffer both sorted ranges live in
+     * @param leftFirst The first index of the left range
+     * @param leftLast The last index + 1 of the left range
+     * @param rightFirst The first index of the right range
+     * @param rightLast The last index + 1 of the right range
+     * @param destination The buffer to merge into
+     * @param destinationIndex Where in destination the merged range starts
+     */
+    template<typename T>
+    void ParallelMerge<T>::mergeRange(
+            const T *source,
+            unsigned int leftFirst, unsigned int leftLast,
+            unsigned int rightFirst, unsigned int rightLast,
+            T *destination, unsigned int destinationIndex
+    ) {
+        unsigned int leftSize = leftLast - leftFirst;
+        unsigned int rightSize = rightLast - rightFirst;
+
+        if (leftSize + rightSize <= mergeCutoff) {
+            while (leftFirst < leftLast && rightFirst < rightLast) {
+                if (source[leftFirst] <= source[rightFirst]) destination[destinationIndex++] = source[leftFirst++];
+                else destination[destinationIndex++] = source[rightFirst++];
+            }
+            while (leftFirst < leftLast) destination[destinationIndex++] = source[leftFirst++];
+            while (rightFirst < rightLast) destination[destinationIndex++] = source[rightFirst++];
+            return;
         }
-        delete[] leftArray;
-        delete[] rightArray;
 
+        // Split on the larger range. Equal values from the left range must stay in front of the right range's
+        unsigned int leftSplit, rightSplit;
+        if (leftSize >= rightSize) {
+            leftSplit = leftFirst + leftSize / 2;
+            rightSplit = std::lower_bound(source + rightFirst, source + rightLast, source[leftSplit]) - source;
+        } else {
+            rightSplit = rightFirst + rightSize / 2;
+            leftSplit = std::upper_bound(source + leftFirst, source + leftLast, source[rightSplit]) - source;
+        }
+        unsigned int destinationSplit = destinationIndex + (leftSplit - leftFirst) + (rightSplit - rightFirst);
+
+        std::atomic<unsigned int> pending{0};
+        pool.submit([=] {
+            mergeRange(source, leftFirst, leftSplit, rightFirst, rightSplit, destination, destinationIndex);
+        }, pending);
+        mergeRange(source, leftSplit, leftLast, rightSplit, rightLast, destination, destinationSplit);
+        pool.wait(pending);
     }
 
 
-// THE REST ARE CURRENTLY NOT USED!
+    /**
+     * This is the class for handling the Least Significant Digit (LSD) Radix Sort Algorithm. Keys are distributed
+     * into 2^DigitBits buckets one digit at a time, starting from the lowest digit, ping-ponging between arr and a
+     * scratch array. Works for any key type with a radix key (see KeyTypes::KeyTraits).
+     * @tparam DigitBits How many bits of the key are sorted per pass (8, 11 and 16 are exposed on the CLI)
+     */
+    template<typename T, unsigned int DigitBits>
+    class LSDRadix : public BaseSort<T> {
+        static_assert(KeyTypes::KeyTraits<T>::hasRadixKey, "Radix sort requires a key type with a radix key");
+        static_assert(DigitBits > 0 && DigitBits <= 16, "Digits wider than 16 bits need too large of a count table");
+
+    public:
+        LSDRadix(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : BaseSort<T>("LSD Radix (" + std::to_string(DigitBits) + "-bit digits)", capacity, canonicalName, verbose, includedValues, includePerf) {}
+
+        ~LSDRadix() { this->freeBuffer(scratch, this->capacity); }
 
+        void runSort();
 
+    protected:
+        void allocateBuffers() override { if (scratch == nullptr) scratch = this->allocateBuffer(this->capacity); }
+
+    private:
+        using Traits = KeyTypes::KeyTraits<T>;
+        static constexpr unsigned int keyBits = sizeof(typename Traits::RadixKey) * 8;
+        static constexpr unsigned int passes = (keyBits + DigitBits - 1) / DigitBits;
+        static constexpr unsigned int buckets = 1u << DigitBits;
+
+        T *scratch{nullptr};
+    };
+
+    /**
+     * The logic for executing the LSD radix sort algorithm. Every digit's counts are gathered in a single read of the
+     * array, and passes where every key shares the same digit are skipped.
+     */
+    template<typename T, unsigned int DigitBits>
+    void LSDRadix<T, DigitBits>::runSort() {
+        std::vector<unsigned int> counts(passes * buckets, 0);
+        for (unsigned int i = 0; i < this->capacity; i++) {
+            auto key = Traits::radixKey(this->arr[i]);
+            for (unsigned int pass = 0; pass < passes; pass++) {
+                counts[pass * buckets + ((key >> (pass * DigitBits)) & (buckets - 1))]++;
+            }
+        }
+
+        T *source = this->arr;
+        T *destination = scratch;
+        for (unsigned int pass = 0; pass < passes; pass++) {
+            unsigned int *count = counts.data() + pass * buckets;
+            unsigned int shift = pass * DigitBits;
+
+            // every key has the same digit, so this pass wouldn't move anything
+            if (count[(Traits::radixKey(source[0]) >> shift) & (buckets - 1)] == this->capacity) continue;
+
+            // turn the counts into starting offsets
+            unsigned int offset = 0;
+            for (unsigned int bucket = 0; bucket < buckets; bucket++) {
+                unsigned int bucketSize = count[bucket];
+                count[bucket] = offset;
+                offset += bucketSize;
+            }
+
+            for (unsigned int i = 0; i < this->capacity; i++) {
+                destination[count[(Traits::radixKey(source[i]) >> shift) & (buckets - 1)]++] = source[i];
+            }
+            std::swap(source, destination);
+        }
+
+        if (source != this->arr) std::copy(source, source + this->capacity, this->arr);
+    }
+
+    /**
+     * This is the class for handling the Most Significant Digit (MSD) Radix Sort Algorithm. It is the in-place
+     * "American flag" variant: each pass counts one byte, then swaps every key directly into its bucket, and recurses
+     * into each bucket on the next byte down. Small buckets are finished with insertion sort. Works for any key type
+     * with a radix key (see KeyTypes::KeyTraits).
+     */
+    template<typename T>
+    class MSDRadix : public BaseSort<T> {
+        static_assert(KeyTypes::KeyTraits<T>::hasRadixKey, "Radix sort requires a key type with a radix key");
 
-    template<typename T, unsigned int K>
-    class ArrayKMerge : public BaseSort<T> {
     public:
-        ArrayKMerge(
+        MSDRadix(
                 const unsigned int capacity,
                 const string &canonicalName = "",
                 const bool &verbose = false,
-                const bool &includedValues = false
-        ) : BaseSort<T>("Array K-Way Merge", capacity, canonicalName, verbose, includedValues) {}
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : BaseSort<T>("MSD Radix", capacity, canonicalName, verbose, includedValues, includePerf) {}
 
         void runSort();
 
     private:
-        void runSort(unsigned int firstIndex, unsigned int lastIndex);
+        void runSort(unsigned int first, unsigned int last, int shift);
+        static unsigned int byteOf(const T &value, int shift) {
+            return (KeyTypes::KeyTraits<T>::radixKey(value) >> shift) & 0xFF;
+        }
+
+        static constexpr unsigned int buckets = 256;
+        static constexpr unsigned int insertionCutoff = 32;
     };
 
-    template<typename T, unsigned int K>
-    void ArrayKMerge<T, K>::runSort() {
-        runSort(0, this->capacity);
+    /**
+     * This is the starter function for the MSD radix sort algorithm.
+     * @IMPORTANT Only run this function as it starts the other is a recursive function
+     */
+    template<typename T>
+    void MSDRadix<T>::runSort() {
+        runSort(0, this->capacity, static_cast<int>(sizeof(typename KeyTypes::KeyTraits<T>::RadixKey) * 8) - 8);
+    }
+
+    /**
+     * This is the recursive function for the MSD radix sort algorithm.
+     * @param first The first element iterator
+     * @param last The last element iterator + 1
+     * @param shift How far to shift a key right to get the current byte
+     * @IMPORTANT DO NOT RUN THIS FUNCTION! IT IS TO BE CALLED FROM THE runSort() WITHOUT ANY PARAMS!!!
+     */
+    template<typename T>
+    void MSDRadix<T>::runSort(unsigned int first, unsigned int last, int shift) {
+        if (last - first <= insertionCutoff) {
+            for (unsigned int i = first + 1; i < last; i++) {
+                T value = this->arr[i];
+                unsigned int j = i;
+                while (j > first && value < this->arr[j - 1]) {
+                    this->arr[j] = this->arr[j - 1];
+                    j--;
+                }
+                this->arr[j] = value;
+            }
+            return;
+        }
+
+        unsigned int bucketStart[buckets + 1] = {0};
+        for (unsigned int i = first; i < last; i++) {
+            bucketStart[byteOf(this->arr[i], shift) + 1]++;
+        }
+        bucketStart[0] = first;
+        for (unsigned int bucket = 1; bucket <= buckets; bucket++) bucketStart[bucket] += bucketStart[bucket - 1];
+
+        // swap each key into its bucket. nextFree marks the first slot in each bucket not yet holding a placed key
+        unsigned int nextFree[buckets];
+        std::copy(bucketStart, bucketStart + buckets, nextFree);
+        for (unsigned int bucket = 0; bucket < buckets; bucket++) {
+            while (nextFree[bucket] < bucketStart[bucket + 1]) {
+                T key = this->arr[nextFree[bucket]];
+                unsigned int keyBucket = byteOf(key, shift);
+                while (keyBucket != bucket) {
+                    KeyTypes::swapValues(key, this->arr[nextFree[keyBucket]++]);
+                    keyBucket = byteOf(key, shift);
+                }
+                this->arr[nextFree[bucket]++] = key;
+            }
+        }
+
+        if (shift == 0) return;
+        for (unsigned int bucket = 0; bucket < buckets; bucket++) {
+            if (bucketStart[bucket + 1] - bucketStart[bucket] > 1) {
+                runSort(bucketStart[bucket], bucketStart[bucket + 1], shift - 8);
+            }
+        }
     }
 
+
+    /**
+     * @brief The start, current position and end (exclusive) of one of the K sorted runs being merged
+     */
     struct KIndexes {
         unsigned int kthStartIndex{0};
         unsigned int kthCurrentIndex{0};
         unsigned int kthEndIndex{0};
     };
 
+    /**
+     * The base class for the K-Way Merge Sort Algorithms. It splits the range into K runs, sorts each run recursively
+     * and merges them. The runs are sorted into the opposite buffer of the one the merge writes to, ping-ponging
+     * between arr and a scratch array allocated once in the constructor. Ranges of K values or fewer are insertion
+     * sorted. Derived classes only decide how the K runs are merged.
+     * @tparam K How many runs are merged at once
+     */
     template<typename T, unsigned int K>
-    void ArrayKMerge<T, K>::runSort(unsigned int firstIndex, unsigned int lastIndex) {
+    class KWayMerge : public BaseSort<T> {
+        static_assert(K >= 2, "A K-way merge needs at least 2 runs");
 
-        if (lastIndex - firstIndex < 2) {
+    public:
+        ~KWayMerge() { this->freeBuffer(scratch, this->capacity); }
+
+        void runSort();
+
+    protected:
+        KWayMerge(
+                const string &sortName,
+                const unsigned int capacity,
+                const string &canonicalName,
+                const bool &verbose,
+                const bool &includedValues,
+                const AlgoGauge::PERF& includePerf
+        ) : BaseSort<T>(sortName + " (K=" + std::to_string(K) + ")", capacity, canonicalName, verbose, includedValues, includePerf) {}
+
+        void allocateBuffers() override { if (scratch == nullptr) scratch = this->allocateBuffer(this->capacity); }
+
+        /**
+         * Merges the K sorted runs of source into destination
+         * @param source The buffer the runs live in
+         * @param runs The K runs. Some may be empty when a range has fewer than K values
+         * @param destination Where the merged values go, starting at runs[0].kthStartIndex
+         * @param numValues The total number of values across all runs
+         */
+        virtual void mergeRuns(const T *source, KIndexes *runs, T *destination, unsigned int numValues) = 0;
+
+    private:
+        void runSort(unsigned int firstIndex, unsigned int lastIndex, bool intoScratch);
+
+        T *scratch{nullptr};
+    };
+
+    /**
+     * This is the starter function for the K-way merge sort algorithms.
+     * @IMPORTANT Only run this function as it starts the other is a recursive function
+     */
+    template<typename T, unsigned int K>
+    void KWayMerge<T, K>::runSort() {
+        runSort(0, this->capacity, false);
+    }
+
+    /**
+     * This is the recursive function for the K-way merge sort algorithms.
+     * @param firstIndex The first element iterator (should be 0 if first recursion call)
+     * @param lastIndex The last element iterator + 1
+     * @param intoScratch Whether the sorted range should end up in the scratch buffer (true) or arr (false)
+     * @IMPORTANT DO NOT RUN THIS FUNCTION! IT IS TO BE CALLED FROM THE runSort() WITHOUT ANY PARAMS!!!
+     */
+    template<typename T, unsigned int K>
+    void KWayMerge<T, K>::runSort(unsigned int firstIndex, unsigned int lastIndex, bool intoScratch) {
+        unsigned int numValues = lastIndex - firstIndex;
+        if (numValues <= K) {
+            // splitting this would leave runs of 0 or 1 values, which costs more to set up than it saves
+            for (unsigned int i = firstIndex + 1; i < lastIndex; i++) {
+                T value = this->arr[i];
+                unsigned int j = i;
+                while (j > firstIndex && value < this->arr[j - 1]) {
+                    this->arr[j] = this->arr[j - 1];
+                    j--;
+                }
+                this->arr[j] = value;
+            }
+            if (intoScratch) std::copy(this->arr + firstIndex, this->arr + lastIndex, scratch + firstIndex);
             return;
         }
 
-        unsigned int numValues = lastIndex - firstIndex;
         KIndexes indexes[K];
-        T *arrayCopy = new T[numValues];
-
-        for (unsigned int i = 0; i < K; i++) {
-            indexes[i].kthStartIndex = numValues * i / K;
-            indexes[i].kthEndIndex = numValues * (i + 1) / K;
-            runSort(firstIndex + indexes[i].kthStartIndex, firstIndex + indexes[i].kthEndIndex);
-        }
-        for (unsigned int i = 0; i < numValues; i++) {
-            arrayCopy[i] = this->arr[firstIndex + i];
-        }
         for (unsigned int i = 0; i < K; i++) {
+            // 64 bit math, numValues * K can overflow an unsigned int
+            indexes[i].kthStartIndex = firstIndex + static_cast<unsigned int>(static_cast<uint64_t>(numValues) * i / K);
+            indexes[i].kthEndIndex = firstIndex + static_cast<unsigned int>(static_cast<uint64_t>(numValues) * (i + 1) / K);
             indexes[i].kthCurrentIndex = indexes[i].kthStartIndex;
+            runSort(indexes[i].kthStartIndex, indexes[i].kthEndIndex, !intoScratch);
         }
 
-        unsigned int itemsSorted = 0;
+        const T *source = intoScratch ? this->arr : scratch;
+        T *destination = intoScratch ? scratch : this->arr;
+        mergeRuns(source, indexes, destination, numValues);
+    }
+
+    /**
+     * This is the class for handling the Array K-Way Merge Sort Algorithm. Each output value is found by scanning the
+     * head of all K runs, so a merge costs K - 1 comparisons per value.
+     */
+    template<typename T, unsigned int K>
+    class ArrayKMerge : public KWayMerge<T, K> {
+    public:
+        ArrayKMerge(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : KWayMerge<T, K>("Array K-Way Merge", capacity, canonicalName, verbose, includedValues, includePerf) {}
+
+    protected:
+        void mergeRuns(const T *source, KIndexes *runs, T *destination, unsigned int numValues) override;
+    };
 
-        while (itemsSorted < numValues) {
-            // Scan across all arrays looking for the smallest
+    template<typename T, unsigned int K>
+    void ArrayKMerge<T, K>::mergeRuns(const T *source, KIndexes *runs, T *destination, unsigned int numValues) {
+        unsigned int destinationIndex = runs[0].kthStartIndex;
+        for (unsigned int itemsSorted = 0; itemsSorted < numValues; itemsSorted++) {
+            // Scan across all runs looking for the smallest
             int arrayWithSmallestValue = -1;
             for (unsigned int i = 0; i < K; i++) {
-                if (indexes[i].kthCurrentIndex < indexes[i].kthEndIndex) {
+                if (runs[i].kthCurrentIndex < runs[i].kthEndIndex) {
                     if (arrayWithSmallestValue == -1) {
                         arrayWithSmallestValue = i;
-                    } else if (arrayCopy[indexes[i].kthCurrentIndex] <
-                               arrayCopy[indexes[arrayWithSmallestValue].kthCurrentIndex]) {
+                    } else if (source[runs[i].kthCurrentIndex] < source[runs[arrayWithSmallestValue].kthCurrentIndex]) {
                         arrayWithSmallestValue = i;
                     }
                 }
             }
             // We've found the smallest, move it in
-            this->arr[firstIndex + itemsSorted] = arrayCopy[indexes[arrayWithSmallestValue].kthCurrentIndex];
-            indexes[arrayWithSmallestValue].kthCurrentIndex++;
-            itemsSorted++;
+            destination[destinationIndex++] = source[runs[arrayWithSmallestValue].kthCurrentIndex++];
         }
-        delete[] arrayCopy;
-
     }
 
-//template <typename T>
-//struct SortSubArrays {
-//	T* rangeStartIndex;
-//	T* currentIndex;
-//	T* rangeEndIndex;
-//};
-
+    /**
+     * A binary min heap of the K runs being merged, ordered by each run's current value. Ties go to the run that
+     * comes first in the array, which keeps the merge stable.
+     */
     template<typename T, unsigned int K>
     class MinHeap {
     public:
-        MinHeap(T *sourceArray, unsigned int sourceArraySize);
+        MinHeap(const T *source, KIndexes *runs);
 
-        void insert(T *item);
-
-        //T getAndReplace(const T& replacement);
+        void insert(KIndexes *run);
         T getSmallest();
 
     private:
-        T *heap[K]; // Make this a stack array and not a heap array for performance.  It's a pointer existing array values and pointer arithmetic
-        unsigned int size;
-        T *sourceArray{nullptr};
-        unsigned int sourceArraySize{0};
-        //SortSubArrays subArrayIndexes[k];
+        bool isBefore(const KIndexes *a, const KIndexes *b) const;
+
+        KIndexes *heap[K]; // Make this a stack array and not a heap array for performance
+        unsigned int size{0};
+        const T *source{nullptr};
     };
 
+    /**
+     * Builds the heap from every non-empty run
+     * @param source The buffer the runs live in
+     * @param runs The K runs
+     */
     template<typename T, unsigned int K>
-    MinHeap<T, K>::MinHeap(T *sourceArray, unsigned int sourceArraySize) {
-        this->sourceArray = sourceArray;
-        this->sourceArraySize = sourceArraySize;
+    MinHeap<T, K>::MinHeap(const T *source, KIndexes *runs) {
+        this->source = source;
         for (unsigned int i = 0; i < K; i++) {
-
-            //if ((i * sourceArraySize) / K == 0) {
-            this->insert(sourceArray + (i * sourceArraySize) / K);
-            //}
-            //else {
-            //	this->insert(sourceArray + (i * sourceArraySize) / K + 1);
-            //}
-            //	unsigned int extra = sourceArraySize % K;
-            //	this->insert(sourceArray + (i * (sourceArraySize + extra)) / K);
-            //}
-            //else {
-            //	this->insert(sourceArray + (i * sourceArraySize) / K);
-            //}
-            //subArrayIndexes[i].rangeStartIndex = sourceArraySize * i / K;
-            //subArrayIndexes[i].currentIndex = sourceArraySize * i / K;
-            //subArrayIndexes[i].rangeEndIndex = sourceArraySize * (i+1) / K;
+            if (runs[i].kthCurrentIndex < runs[i].kthEndIndex) this->insert(runs + i);
         }
     }
 
     template<typename T, unsigned int K>
-    void MinHeap<T, K>::insert(T *item) {
+    bool MinHeap<T, K>::isBefore(const KIndexes *a, const KIndexes *b) const {
+        if (source[a->kthCurrentIndex] < source[b->kthCurrentIndex]) return true;
+        if (source[b->kthCurrentIndex] < source[a->kthCurrentIndex]) return false;
+        return a < b;
+    }
 
+    template<typename T, unsigned int K>
+    void MinHeap<T, K>::insert(KIndexes *run) {
         unsigned int currIndex = size;
-
-        heap[size] = item;
+        heap[size] = run;
         size++;
 
         // Work upward
-        while (currIndex > 0 && *heap[currIndex] < *heap[(currIndex - 1) / 2]) {
-            //swap
-            T *temp = heap[currIndex];
-            heap[currIndex] = heap[(currIndex - 1) / 2];
-            heap[(currIndex - 1) / 2] = temp;
+        while (currIndex > 0 && isBefore(heap[currIndex], heap[(currIndex - 1) / 2])) {
+            std::swap(heap[currIndex], heap[(currIndex - 1) / 2]);
             currIndex = (currIndex - 1) / 2;
         }
     }
 
+    /**
+     * Takes the smallest value off the top and advances its run. Must not be called once every run is empty
+     * @return The smallest value across all runs
+     */
     template<typename T, unsigned int K>
     T MinHeap<T, K>::getSmallest() {
+        KIndexes *top = heap[0];
+        T retVal = source[top->kthCurrentIndex++];
 
-        // Get top, replace it with the last item to keep the tree balanced
-        T retVal = *heap[0];
-
-        // See if this subarray has more values or not.
-        if (((int(heap[0] - sourceArray) + 2) * K - 1) % sourceArraySize >= K) {
-            // We're still within a subarray, use the next value of the subarray
-            heap[0] = heap[0] + 1;
-        } else {
-            // This sub array is done.  Put the last leaf of the heap at root
-            if (size == 0) {
-                cout << "break here" << endl;
-            }
-            heap[0] = heap[size - 1];
+        // This run is done.  Put the last leaf of the heap at root
+        if (top->kthCurrentIndex == top->kthEndIndex) {
             size--;
+            heap[0] = heap[size];
         }
 
         // Work downward
@@ -985,81 +3047,198 @@ void Bubble<T>::runSort() {
             unsigned int left = 2 * parent + 1;
             unsigned int right = 2 * parent + 2;
             unsigned int smallest = parent;
-            if (left < size && *heap[left] < *heap[smallest])
+            if (left < size && isBefore(heap[left], heap[smallest]))
                 smallest = left;
 
-            if (right < size && *heap[right] < *heap[smallest])
+            if (right < size && isBefore(heap[right], heap[smallest]))
                 smallest = right;
 
-            if (smallest != parent) {
-                T *temp = heap[parent];
-                heap[parent] = heap[smallest];
-                heap[smallest] = temp;
-                // Prepare for next loop
-                parent = smallest;
-            } else {
-                break;
-            }
+            if (smallest == parent) break;
+            std::swap(heap[parent], heap[smallest]);
+            parent = smallest;
         }
 
         return retVal;
-
     }
 
+    /**
+     * This is the class for handling the Heap K-Way Merge Sort Algorithm. The heads of the K runs are kept in a min
+     * heap, so a merge costs about 2 * log2(K) comparisons per value.
+     */
     template<typename T, unsigned int K>
-    class HeapKMerge : public BaseSort<T> {
+    class HeapKMerge : public KWayMerge<T, K> {
     public:
         HeapKMerge(
                 const unsigned int capacity,
                 const string &canonicalName = "",
                 const bool &verbose = false,
-                const bool &includedValues = false
-        ) : BaseSort<T>("Heap - K-Way Merge", capacity, canonicalName, verbose, includedValues) {}
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : KWayMerge<T, K>("Heap K-Way Merge", capacity, canonicalName, verbose, includedValues, includePerf) {}
 
-        void runSort();
+    protected:
+        void mergeRuns(const T *source, KIndexes *runs, T *destination, unsigned int numValues) override;
+    };
+
+    template<typename T, unsigned int K>
+    void HeapKMerge<T, K>::mergeRuns(const T *source, KIndexes *runs, T *destination, unsigned int numValues) {
+        MinHeap<T, K> minHeap(source, runs);
+        unsigned int destinationIndex = runs[0].kthStartIndex;
+        for (unsigned int itemsSorted = 0; itemsSorted < numValues; itemsSorted++) {
+            destination[destinationIndex++] = minHeap.getSmallest();
+        }
+    }
+
+    /**
+     * A tournament tree of losers over the K runs being merged. Each internal node remembers the run that lost the
+     * match played there, and the overall winner sits in node 0. Replacing the winner only replays the matches on its
+     * path to the root: exactly log2(K) comparisons, always against the same nodes, with no branching on which child
+     * to follow like a heap has. Exhausted runs lose every match.
+     */
+    template<typename T, unsigned int K>
+    class LoserTree {
+    public:
+        LoserTree(const T *source, KIndexes *runs);
+
+        T getSmallest();
 
     private:
-        void runSort(unsigned int firstIndex, unsigned int lastIndex);
+        static constexpr unsigned int leafCount() {
+            unsigned int leaves = 1;
+            while (leaves < K) leaves <<= 1;
+            return leaves;
+        }
+
+        bool beats(unsigned int a, unsigned int b) const;
+        unsigned int playMatches(unsigned int node);
 
+        static constexpr unsigned int leaves = leafCount(); // K rounded up to a power of two. The extra leaves are empty
+        unsigned int tree[leaves];
+        const T *source{nullptr};
+        KIndexes *runs{nullptr};
     };
 
+    /**
+     * Plays the initial tournament
+     * @param source The buffer the runs live in
+     * @param runs The K runs
+     */
     template<typename T, unsigned int K>
-    void HeapKMerge<T, K>::runSort() {
-        runSort(0, this->capacity);
+    LoserTree<T, K>::LoserTree(const T *source, KIndexes *runs) {
+        this->source = source;
+        this->runs = runs;
+        tree[0] = playMatches(1);
     }
 
+    /**
+     * @return true if run a's current value should be output before run b's. Ties go to the earlier run
+     */
     template<typename T, unsigned int K>
-    void HeapKMerge<T, K>::runSort(unsigned int firstIndex, unsigned int lastIndex) {
-
-        if (lastIndex - firstIndex < 2) {
-            return;
-        }
+    bool LoserTree<T, K>::beats(unsigned int a, unsigned int b) const {
+        bool aDone = a >= K || runs[a].kthCurrentIndex == runs[a].kthEndIndex;
+        bool bDone = b >= K || runs[b].kthCurrentIndex == runs[b].kthEndIndex;
+        if (aDone || bDone) return !aDone;
+        if (source[runs[a].kthCurrentIndex] < source[runs[b].kthCurrentIndex]) return true;
+        if (source[runs[b].kthCurrentIndex] < source[runs[a].kthCurrentIndex]) return false;
+        return a < b;
+    }
 
-        unsigned int numValues = lastIndex - firstIndex;
-        for (unsigned int i = 0; i < K; i++) {
-            runSort(firstIndex + numValues * i / K, firstIndex + numValues * (i + 1) / K);
+    /**
+     * Recursively plays every match below node, storing the loser in each node
+     * @return The run that won the subtree
+     */
+    template<typename T, unsigned int K>
+    unsigned int LoserTree<T, K>::playMatches(unsigned int node) {
+        if (node >= leaves) return node - leaves;
+        unsigned int left = playMatches(2 * node);
+        unsigned int right = playMatches(2 * node + 1);
+        if (beats(left, right)) {
+            tree[node] = right;
+            return left;
         }
+        tree[node] = left;
+        return right;
+    }
 
-        T *arrayCopy = new T[numValues];
-        for (unsigned int i = 0; i < numValues; i++) {
-            arrayCopy[i] = this->arr[firstIndex + i];
+    /**
+     * Takes the winner's value, advances the winner's run and replays its path to the root. Must not be called once
+     * every run is empty
+     * @return The smallest value across all runs
+     */
+    template<typename T, unsigned int K>
+    T LoserTree<T, K>::getSmallest() {
+        unsigned int winner = tree[0];
+        T retVal = source[runs[winner].kthCurrentIndex++];
+        for (unsigned int node = (winner + leaves) / 2; node > 0; node /= 2) {
+            if (beats(tree[node], winner)) std::swap(tree[node], winner);
         }
+        tree[0] = winner;
+        return retVal;
+    }
 
-        // Build heap.  First put all values in the heap.
-        MinHeap<T, K> minHeap(arrayCopy, numValues);
+    /**
+     * This is the class for handling the Loser Tree K-Way Merge Sort Algorithm. The heads of the K runs are kept in a
+     * tournament tree of losers, so a merge costs log2(K) comparisons per value.
+     */
+    template<typename T, unsigned int K>
+    class LoserTreeKMerge : public KWayMerge<T, K> {
+    public:
+        LoserTreeKMerge(
+                const unsigned int capacity,
+                const string &canonicalName = "",
+                const bool &verbose = false,
+                const bool &includedValues = false,
+                const AlgoGauge::PERF& includePerf = perfOFF
+        ) : KWayMerge<T, K>("Loser Tree K-Way Merge", capacity, canonicalName, verbose, includedValues, includePerf) {}
 
-        unsigned int itemsSorted = 0;
+    protected:
+        void mergeRuns(const T *source, KIndexes *runs, T *destination, unsigned int numValues) override;
+    };
 
-        while (itemsSorted < numValues) {
+    template<typename T, unsigned int K>
+    void LoserTreeKMerge<T, K>::mergeRuns(const T *source, KIndexes *runs, T *destination, unsigned int numValues) {
+        LoserTree<T, K> loserTree(source, runs);
+        unsigned int destinationIndex = runs[0].kthStartIndex;
+        for (unsigned int itemsSorted = 0; itemsSorted < numValues; itemsSorted++) {
+            destination[destinationIndex++] = loserTree.getSmallest();
+        }
+    }
 
-            this->arr[firstIndex + itemsSorted] = minHeap.getSmallest();
+    /**
+     * @brief The values of K the K-way merge sorts are compiled for. K must be a compile time constant so the run
+     * bookkeeping can live on the stack, so only these are selectable at runtime
+     */
+    static const unsigned int KWayMergeKValues[] = {2, 4, 8, 16, 32, 64};
 
-            itemsSorted++;
+    /**
+     * Creates a K-way merge sort for a K chosen at runtime
+     * @tparam KMergeSort One of ArrayKMerge, HeapKMerge or LoserTreeKMerge
+     * @param k The number of runs to merge at once. Must be one of KWayMergeKValues
+     * @return The sorting algorithm object
+     */
+    template<template<typename, unsigned int> class KMergeSort, typename T>
+    std::unique_ptr<BaseSort<T>> makeKWayMerge(
+            const unsigned int k,
+            const unsigned int capacity,
+            const string &canonicalName = "",
+            const bool &verbose = false,
+            const bool &includedValues = false,
+            const AlgoGauge::PERF& includePerf = perfOFF
+    ) {
+        switch (k) {
+            case 2: return std::make_unique<KMergeSort<T, 2>>(capacity, canonicalName, verbose, includedValues, includePerf);
+            case 4: return std::make_unique<KMergeSort<T, 4>>(capacity, canonicalName, verbose, includedValues, includePerf);
+            case 8: return std::make_unique<KMergeSort<T, 8>>(capacity, canonicalName, verbose, includedValues, includePerf);
+            case 16: return std::make_unique<KMergeSort<T, 16>>(capacity, canonicalName, verbose, includedValues, includePerf);
+            case 32: return std::make_unique<KMergeSort<T, 32>>(capacity, canonicalName, verbose, includedValues, includePerf);
+            case 64: return std::make_unique<KMergeSort<T, 64>>(capacity, canonicalName, verbose, includedValues, includePerf);
+            default: throw std::invalid_argument("K must be one of 2, 4, 8, 16, 32 or 64 for a K-way merge. Got: " + std::to_string(k));
         }
-        delete[] arrayCopy;
-
     }
 
+
+// THE REST ARE CURRENTLY NOT USED!
+
     /**
      * Runs and prints out the sort. This is no longer used. This was included in the original
      * file that was handed to me by Brad. Since I converted this file to a library, this function
@@ -25,6 +25,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <iomanip>
@@ -89,8 +90,18 @@ struct PerfEvent
 		int fd;
 		read_format prev;
 		read_format data;
+		bool accumulated = false; // grouped mode: the counter is averaged over every run it was measured in
+		double total = 0;
+		unsigned runs = 0;
 
 		double readCounter()
+		{
+			if (accumulated)
+				return runs ? total / runs : NAN; // NAN when the counter's group never ran
+			return readDelta();
+		}
+
+		double readDelta()
 		{
 			double multiplexingCorrection = static_cast<double>(data.time_enabled - prev.time_enabled) / static_cast<double>(data.time_running - prev.time_running);
 			return static_cast<double>(data.value - prev.value) * multiplexingCorrection;
@@ -110,61 +121,82 @@ struct PerfEvent
 	std::chrono::time_point<std::chrono::steady_clock> startTime;
 	std::chrono::time_point<std::chrono::steady_clock> stopTime;
 
+	// Grouped mode. Without it every counter is opened on its own, so when there are more counters than the PMU has
+	// registers the kernel multiplexes each one over different time windows and scales them up separately. Grouped, the
+	// hardware counters are split into groups that fit the PMU, each group is read in one go through its leader, and
+	// each run measures the next group in turn
+	bool grouped = false;
+	unsigned maxGroupSize = 4;
+	std::vector<unsigned> groupStarts; // indexes of events registered right after startGroup()
+	std::vector<std::vector<unsigned>> groups; // the events of each group, leader first
+	std::vector<uint64_t> groupPrev;
+	unsigned currentGroup = 0;
+	unsigned runs = 0;
+	double totalDuration = 0;
+
+
+
+	/// @brief A counter the constructor registers
+	struct CounterDefinition
+	{
+		const char *name;
+		uint64_t type;
+		uint64_t eventID;
+		EventDomain domain;
+		bool startsGroup; // in grouped mode, leads a new group (see startGroup())
+	};
 
+	/// @brief The counters every PerfEvent measures, in the order they are reported. They are listed up front so the
+	/// report's names are known before any counter is opened, even when some can't be
+	/// @return The counters
+	static const std::vector<CounterDefinition> &defaultCounters(){
+		static const std::vector<CounterDefinition> counters = {
+			{"task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, ALL, false},
+			{"context switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, ALL, false},
+
+			// counters that are divided by each other are kept in the same group, so both come from the same runs
+			{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, ALL, true},
+			{"cpu_refrence_cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES, ALL, false},
+			{"kcycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, KERNEL, false},
+			{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, ALL, false},
+
+			{"L1 Data Cache", PERF_TYPE_HW_CACHE,
+				(PERF_COUNT_HW_CACHE_L1D) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16), ALL, true},
+			{"L1 Data Cache Misses", PERF_TYPE_HW_CACHE,
+				(PERF_COUNT_HW_CACHE_L1D) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), ALL, false},
+			// {"L1 Instruction Cache", PERF_TYPE_HW_CACHE,
+			// 	(PERF_COUNT_HW_CACHE_L1I) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16), ALL, false},
+			{"L1 Instruction Misses", PERF_TYPE_HW_CACHE,
+				(PERF_COUNT_HW_CACHE_L1D) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), ALL, false},
+
+			{"branch predictions", PERF_TYPE_HW_CACHE,
+				(PERF_COUNT_HW_CACHE_BPU) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16), ALL, true},
+			{"branch prediction misses", PERF_TYPE_HW_CACHE,
+				(PERF_COUNT_HW_CACHE_BPU) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), ALL, false},
+
+			{"cache references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, ALL, true},
+			{"cache misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, ALL, false},
+			{"retired branch instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, ALL, false},
+
+			{"total page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, ALL, false},
+			{"minor page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN, ALL, false},
+			{"major page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ, ALL, false},
+			{"CPU Migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, ALL, false}
+		};
+		return counters;
+	}
 
 	/// @brief This is the constutor for PERF it holds all the attributes that should be tracked task-clock cycles etc.
 	/// @param pid Optionally pass in the PID of what process track default 0 or the caller function
-	PerfEvent(pid_t pid = 0){
-		registerCounter("task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
-		registerCounter("context switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
-
-		registerCounter("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
-		registerCounter("cpu_refrence_cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES);
-
-		registerCounter("kcycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, KERNEL);
-
-		registerCounter("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
-
-		registerCounter("L1 Data Cache", PERF_TYPE_HW_CACHE, 
-			(PERF_COUNT_HW_CACHE_L1D) | 
-			(PERF_COUNT_HW_CACHE_OP_READ << 8) | 
-			(PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16)
-		);
-		registerCounter("L1 Data Cache Misses", PERF_TYPE_HW_CACHE, 
-			(PERF_COUNT_HW_CACHE_L1D) | 
-			(PERF_COUNT_HW_CACHE_OP_READ << 8) | 
-			(PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
-		);
-		// registerCounter("L1 Instruction Cache", PERF_TYPE_HW_CACHE, 
-		// 	(PERF_COUNT_HW_CACHE_L1I) | 
-		// 	(PERF_COUNT_HW_CACHE_OP_READ << 8) | 
-		// 	(PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16)
-		// );
-		registerCounter("L1 Instruction Misses", PERF_TYPE_HW_CACHE, 
-			(PERF_COUNT_HW_CACHE_L1D) | 
-			(PERF_COUNT_HW_CACHE_OP_READ << 8) | 
-			(PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
-		);
-
-		registerCounter("branch predictions", PERF_TYPE_HW_CACHE, 			
-			(PERF_COUNT_HW_CACHE_BPU) |
-            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
-            (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16)
-		);
-		registerCounter("branch prediction misses", PERF_TYPE_HW_CACHE, 			
-			(PERF_COUNT_HW_CACHE_BPU) |
-            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
-            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
-		);
-
-		registerCounter("cache references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
-		registerCounter("cache references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
-		registerCounter("retired branch instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
-
-		registerCounter("total page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
-		registerCounter("minor page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN);
-		registerCounter("major page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ);
-		registerCounter("CPU Migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS);
+	/// @param grouped Whether to schedule the hardware counters in groups (see startGroup()), measuring one group per
+	/// run. Every counter is then reported as its average over the runs it was measured in
+	/// @param maxGroupSize The most hardware counters in one group. Most PMUs have at least 4 general purpose registers
+	PerfEvent(pid_t pid = 0, bool grouped = false, unsigned maxGroupSize = 4) : grouped(grouped), maxGroupSize(maxGroupSize) {
+		for (const auto &counter : defaultCounters()){
+			if (counter.startsGroup)
+				startGroup();
+			registerCounter(counter.name, counter.type, counter.eventID, counter.domain);
+		}
 
 		// additional counters can be found in linux/perf_event.h
 
@@ -190,17 +222,47 @@ struct PerfEvent
 
 		//    {"IPC", "1.80"}
 		// };
+		if (grouped){
+			openGrouped(pid);
+			return;
+		}
+		openIndependent(pid);
+	}
+
+	/// @brief Tag for the constructor that only counts what the scheduler did
+	struct SchedulerCounters {};
+
+	/// @brief Only counts context switches and CPU migrations. Both are software counters, so unlike the full set
+	/// they can be opened on machines without a PMU (like most virtual machines)
+	/// @param pid Optionally pass in the PID of what process track default 0 or the caller function
+	explicit PerfEvent(SchedulerCounters, pid_t pid = 0) {
+		registerCounter("context switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+		registerCounter("CPU Migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS);
+		openIndependent(pid);
+	}
+
+	/// @brief Opens every registered counter on its own. If one can't be opened none are kept
+	void openIndependent(pid_t pid){
 		for (unsigned i = 0; i < events.size(); i++){
 			auto &event = events[i];
 			event.fd = static_cast<int>(syscall(__NR_perf_event_open, &event.pe, pid, -1, -1, 0)); // int syscall(SYS_perf_event_open, struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags);
 			if (event.fd < 0){
 				std::cerr << "Error opening counter " << names[i] << std::endl;
-				events.resize(0);
-				names.resize(0);
+				closeAll(i);
 				return;
 			}
 		}
 	}
+
+	/// @brief In grouped mode, makes the next registered hardware counter lead a new group
+	void startGroup(){
+		groupStarts.push_back(static_cast<unsigned>(events.size()));
+	}
+
+	/// @brief The number of runs it takes to measure every counter once in grouped mode (0 otherwise)
+	unsigned getGroupCount() const {
+		return static_cast<unsigned>(groups.size());
+	}
 	/// @brief Used to register your own events that aren't found in the constructor. Find more in linux/perf_event.h
 	/// @param name The name of the event
 	/// @param type The PERF_TYPE: Hardware, Software...
@@ -224,11 +286,74 @@ struct PerfEvent
 		pe.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
 	}
 
+private:
+	/// @brief Closes the first count counters and drops every counter, after one couldn't be opened
+	void closeAll(unsigned count){
+		for (unsigned i = 0; i < count; i++)
+			if (events[i].fd >= 0)
+				close(events[i].fd);
+		events.resize(0);
+		names.resize(0);
+		groups.clear();
+	}
+
+	/// @brief Opens the software counters on their own (they are never multiplexed) and the hardware counters in groups
+	/// @param pid The process to count
+	void openGrouped(pid_t pid){
+		for (unsigned i = 0; i < events.size(); i++){
+			auto &event = events[i];
+			event.accumulated = true;
+			int groupFd = -1;
+			if (event.pe.type != PERF_TYPE_SOFTWARE){
+				const bool marked = std::find(groupStarts.begin(), groupStarts.end(), i) != groupStarts.end();
+				if (groups.empty() || marked || groups.back().size() >= maxGroupSize)
+					groups.emplace_back();
+				else
+					groupFd = events[groups.back().front()].fd;
+				groups.back().push_back(i);
+				// the leader enables and disables the whole group, and one read of it returns every member
+				event.pe.disabled = groupFd == -1;
+				event.pe.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			}
+			event.fd = static_cast<int>(syscall(__NR_perf_event_open, &event.pe, pid, -1, groupFd, 0));
+			if (event.fd < 0 && event.pe.inherit){
+				// older kernels can't read a group that child threads inherit
+				event.pe.inherit = 0;
+				event.fd = static_cast<int>(syscall(__NR_perf_event_open, &event.pe, pid, -1, groupFd, 0));
+			}
+			if (event.fd < 0){
+				std::cerr << "Error opening counter " << names[i] << std::endl;
+				closeAll(i);
+				return;
+			}
+		}
+	}
+
+	/// @brief Reads every counter of a group at once
+	/// @param group The group's events, leader first
+	/// @return The number of counters, the time enabled and the time running, then each counter's value
+	std::vector<uint64_t> readGroup(const std::vector<unsigned> &group){
+		std::vector<uint64_t> values(3 + group.size());
+		const auto bytes = static_cast<ssize_t>(values.size() * sizeof(uint64_t));
+		if (read(events[group.front()].fd, values.data(), values.size() * sizeof(uint64_t)) != bytes)
+			std::cerr << "Error reading counter group " << names[group.front()] << std::endl;
+		return values;
+	}
+
+public:
 	/// @brief Start recording the registered counters
 	void startCounters(){
+		if (grouped && !groups.empty()){
+			auto &group = groups[currentGroup];
+			ioctl(events[group.front()].fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(events[group.front()].fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+			groupPrev = readGroup(group);
+		}
 		for (unsigned i = 0; i < events.size(); i++)
 		{
 			auto &event = events[i];
+			if (grouped && event.pe.type != PERF_TYPE_SOFTWARE)
+				continue;
 			ioctl(event.fd, PERF_EVENT_IOC_RESET, 0);
 			ioctl(event.fd, PERF_EVENT_IOC_ENABLE, 0);
 			if (read(event.fd, &event.prev, sizeof(uint64_t) * 3) != sizeof(uint64_t) * 3)
@@ -250,15 +375,42 @@ struct PerfEvent
 		for (unsigned i = 0; i < events.size(); i++)
 		{
 			auto &event = events[i];
+			if (grouped && event.pe.type != PERF_TYPE_SOFTWARE)
+				continue;
 			if (read(event.fd, &event.data, sizeof(uint64_t) * 3) != sizeof(uint64_t) * 3)
 				std::cerr << "Error reading counter " << names[i] << std::endl;
 			ioctl(event.fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (grouped){
+				event.total += event.readDelta();
+				event.runs++;
+			}
+		}
+		if (!grouped || events.empty())
+			return;
+
+		if (!groups.empty()){
+			auto &group = groups[currentGroup];
+			const std::vector<uint64_t> values = readGroup(group);
+			ioctl(events[group.front()].fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+			// the whole group shares one time enabled and running, so every member is scaled the same way
+			const uint64_t running = values[2] - groupPrev[2];
+			const double multiplexingCorrection = running ? static_cast<double>(values[1] - groupPrev[1]) / static_cast<double>(running) : NAN;
+			for (unsigned member = 0; member < group.size(); member++){
+				auto &event = events[group[member]];
+				event.total += static_cast<double>(values[3 + member] - groupPrev[3 + member]) * multiplexingCorrection;
+				event.runs++;
+			}
+			currentGroup = (currentGroup + 1) % static_cast<unsigned>(groups.size());
 		}
+		runs++;
+		totalDuration += std::chrono::duration<double>(stopTime - startTime).count();
 	}
 
 	/// @brief Get how long the Counters where recording
-	/// @return The time
+	/// @return The time. The average run in grouped mode
 	double getDuration(){
+		if (grouped && runs)
+			return totalDuration / runs;
 		return std::chrono::duration<double>(stopTime - startTime).count();
 	}
 	/// @brief Get how many instructions per cylce where called
@@ -437,6 +589,37 @@ public:
 		return report;
 	}
 
+	/// @brief The names of everything getPerfJSONString() can report, in order: every default counter, then the
+	/// groups and runs of grouped mode, the scale, GHz, IPC and CPUs
+	/// @return The names
+	static std::vector<std::string> getReportNames(){
+		std::vector<std::string> reportNames;
+		for (const auto &counter : defaultCounters())
+			reportNames.push_back(counter.name);
+		for (const char *name : {"groups", "runs", "scale", "GHz", "IPC", "CPUs"})
+			reportNames.push_back(name);
+		return reportNames;
+	}
+
+	/// @brief The same values as getPerfJSONString(), as numbers
+	/// @param normalizationConstant A constant used to normalize the counters (default is 1)
+	/// @return A value for each of getReportNames(). NAN for a counter that couldn't be opened, and for the groups and
+	/// runs outside of grouped mode
+	std::vector<double> getReport(uint64_t normalizationConstant = 1){
+		std::vector<double> report;
+		for (const auto &counter : defaultCounters()){
+			const auto name = std::find(names.begin(), names.end(), counter.name);
+			report.push_back(name == names.end() ? NAN : events[name - names.begin()].readCounter() / static_cast<double>(normalizationConstant));
+		}
+		report.push_back(grouped ? static_cast<double>(groups.size()) : NAN);
+		report.push_back(grouped ? static_cast<double>(runs) : NAN);
+		report.push_back(static_cast<double>(normalizationConstant));
+		report.push_back(getGHz());
+		report.push_back(std::isnan(getIPC()) ? -1 : getIPC());
+		report.push_back(getCPUs());
+		return report;
+	}
+
 	/// @brief Gets the perf results as a string JSON. If not on linux it will return the Dummy Data JSON string
 	/// @param normalizationConstant A constant used to normalize the data values may be required depending on CPU (default is 1).
 	/// @param precision The number of decimal places for floating-point values (default is 6).
@@ -449,9 +632,11 @@ public:
 			std::stringstream stream;
 			stream << std::setprecision(precision) << events[i].readCounter() / static_cast<double>(normalizationConstant);
 			// std::cout << stream.str();
-			jsonString += "\"" + names[i] + "\":" + (stream.str() != "-nan"? stream.str(): "null") + ",";
+			jsonString += "\"" + names[i] + "\":" + (stream.str() != "-nan" && stream.str() != "nan"? stream.str(): "null") + ",";
 		}
 		std::ostringstream stream;
+		if (grouped)
+			stream << "\"groups\":" << groups.size() << ",\"runs\":" << runs << ",";
 		stream << "\"scale\":" << std::setprecision(precision) << normalizationConstant << ",";
 		stream << "\"GHz\":" << std::fixed << std::setprecision(precision) << getGHz() << ",";
 		stream << "\"IPC\":" << std::fixed << std::setprecision(precision) << (std::isnan(getIPC()) ? -1: getIPC()) << ",";
@@ -488,10 +673,18 @@ public:
 
 struct PerfEvent {
 
-	PerfEvent(pid_t pid = 0){
+	PerfEvent(pid_t pid = 0, bool grouped = false, unsigned maxGroupSize = 4){
+
+	}
+
+	struct SchedulerCounters {};
+	explicit PerfEvent(SchedulerCounters, pid_t pid = 0){
 
 	}
 
+	unsigned getGroupCount() const { return 0; }
+	double getCounter(const std::string &name){ return -1; }
+
 
    void startCounters() {}
    void stopCounters() {}
@@ -500,6 +693,20 @@ struct PerfEvent {
 	double getDuration(){
 		return 0;
 	}
+	static std::vector<std::string> getReportNames(){
+		std::vector<std::string> reportNames;
+		for (const auto &event : dummyData)
+			reportNames.push_back(event.first);
+		return reportNames;
+	}
+
+	std::vector<double> getReport(uint64_t normalizationConstant = 1){
+		std::vector<double> report;
+		for (const auto &event : dummyData)
+			report.push_back(event.second / normalizationConstant);
+		return report;
+	}
+
    std::string getPerfJSONString(uint64_t normalizationConstant = 1, uint8_t precision = 6)
 	{
 		return getPerfJSONStringDummy(normalizationConstant, precision);